@@ -0,0 +1,132 @@
+#ifndef _THREAD_EX_ACTOR_INCLUDED_
+#define _THREAD_EX_ACTOR_INCLUDED_
+
+/**
+	\file 	te_actor.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <memory>
+#include <queue>
+#include <list>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_container.h"
+#include "te_thread_pool.h"
+
+/**
+   \brief an actor is a mailbox and a handler of its messages, the actors share the workers of a thread_pool
+
+   A thread per actor (a threadsafe_queue and a joined_thread) limits a process to a few hundred actors.
+   An actor here owns no thread:
+   - 'send' puts a message into the mailbox, the first message of an empty mailbox posts an activation of the actor to the pool
+   - an activation handles up to 'batch' messages, then it posts the next activation if there are more of them,
+     so a busy actor does not keep a worker from the others
+   - there is no more than one activation of an actor at a time: the messages of an actor are handled one by one, in order of sending
+   An idle actor costs its mailbox only, 100k actors run on a handful of workers.
+
+   actor is a handle, its copies are the same actor. The actor lives while there is a handle or an activation of it,
+   the pool must outlive the actors. The handler must not throw (see thread_pool::post).
+
+   \remark "Actors: A Model of Concurrent Computation in Distributed Systems", G. Agha
+   \remark https://doc.akka.io/docs/akka/current/typed/dispatchers.html (throughput of a dispatcher)
+   \example unit/test_actor.cpp
+*/
+
+namespace thread_ex
+{
+
+namespace acis // actor_internals
+{
+   template <typename Message>
+   class actor_core : public std::enable_shared_from_this<actor_core<Message>>
+   {
+         // nobody waits on a mailbox, an activation is posted instead.
+         // std::list based: an empty std::deque holds a buffer, that is the whole cost of an idle actor multiplied by 100k
+      using mailbox_type = mutex_wrap<Message, std::queue<Message, std::list<Message>>>;
+
+   public:
+      template <typename Handler>
+      actor_core(thread_pool& pool, Handler&& h, size_t batch)
+         : pool_(pool), handler_(std::forward<Handler>(h)), batch_(batch?batch:1) {}
+
+      template <typename M>
+      void     send(M&& m)
+      {
+         mailbox_.push(std::forward<M>(m));
+         if(0==pending_.fetch_add(1, std::memory_order_acq_rel))
+            activate_later();
+      }
+      size_t   pending() const noexcept { return pending_.load(std::memory_order_acquire); }
+
+   private:
+      void     activate_later()
+      {
+         pool_.post([self=this->shared_from_this()] { self->activate(); });
+      }
+
+      void     activate()
+      {
+            // the counted messages are in the mailbox, the ones being sent are taken by the next activation
+         const size_t n = std::min(batch_, pending_.load(std::memory_order_acquire));
+         mailbox_.pop(std::nothrow, taken_, n);
+         while(!taken_.empty())
+         {
+            handler_(std::move(taken_.front()));
+            taken_.pop();
+         }
+         if(pending_.fetch_sub(n, std::memory_order_acq_rel) > n)
+            activate_later();
+      }
+
+   private:
+      thread_pool&                        pool_;
+      std::function<void(Message&&)>      handler_;
+      const size_t                        batch_;
+      mailbox_type                        mailbox_;
+      std::atomic<size_t>                 pending_ {0};  // messages sent and not handled yet, the actor is active while there are some
+      typename mailbox_type::container_type  taken_;     // owned by the activation
+   };
+}  // end of 'actor_internals'
+
+template <typename Message>
+class actor
+{
+public:
+   using message_type = Message;
+      // messages handled per activation
+   static constexpr size_t default_batch = 64;
+
+      // h(Message&&) handles the messages on the workers of 'pool'
+   template <typename Handler>
+   actor(thread_pool& pool, Handler&& h, size_t batch = default_batch);
+
+   void     send(Message&& m)       { core_->send(std::move(m)); }
+   void     send(const Message& m)  { core_->send(m); }
+      // the messages not handled yet
+   size_t   pending() const noexcept { return core_->pending(); }
+
+private:
+   std::shared_ptr<acis::actor_core<Message>> core_;
+};
+
+template <typename Message>
+template <typename Handler>
+inline
+actor<Message>::actor(thread_pool& pool, Handler&& h, size_t batch)
+   : core_(std::make_shared<acis::actor_core<Message>>(pool, std::forward<Handler>(h), batch))
+{
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_ACTOR_INCLUDED_
@@ -12,15 +12,29 @@
 
 #include "te_compiler_warning_suppress.h"
 #include <future>
+#include <functional>
+#include <memory>
 #include <type_traits>
 #include <utility>
+#include <tuple>
 #include "te_compiler_warning_rollback.h"
 #include "te_compiler.h"
+#include "te_concurrency_governor.h"
+#include "te_thread_cache.h"
+#include "te_observable_future.h"
 
 
 /**
    \brief a function that acts like std::async, but that automatically uses std::launch::async as the launch policy 
    \remark "Effective Modern C++" by Scott Meyers, item:36, page 249
+
+   The asynchronous call takes a token of concurrency_governor::global() if there is a free one,
+   so thread pools see the thread as a busy one. It never waits for a token though: 
+   the call runs concurrently whatever the budget is, that is the only reason for call_async to exist.
+
+   call_async(pooled, f, args...) runs 'f' on default_thread_cache() rather than on a new thread, the thread is reused by the next calls.
+   The guarantee is the same: if there is no idle thread in the cache, a new one is started for the call.
+   Its future is observable_future (see te_observable_future.h), when_all and when_any combine such futures by callbacks.
    \note
    http://en.cppreference.com/w/cpp/thread/async
    http://en.cppreference.com/w/cpp/thread/launch
@@ -29,17 +43,59 @@
 namespace thread_ex
 {
 
-template <typename Function, typename... Args>
+   // the launch policy of call_async: the call runs on a cached thread (see te_thread_cache.h)
+struct pooled_t { explicit pooled_t() = default; };
+constexpr pooled_t pooled {};
+
+template 
+<
+    typename Function, typename... Args
+   ,typename = std::enable_if_t<!std::is_same<std::decay_t<Function>, pooled_t>::value>
+>
 inline 
 std::future<typename std::result_of<Function(Args...)>::type> 
 call_async(Function&& f, Args&&... args)
 {
+    auto governed = [](auto&& g, auto&&... a) -> decltype(auto) {
+        concurrency_token token {concurrency_governor::global(), std::try_to_lock};
+        return std::ref(g)(std::forward<decltype(a)>(a)...);   // INVOKE, pointers to members are supported
+    };
     return std::async(std::launch::async
+        ,governed
         ,std::forward<Function>(f)
         ,std::forward<Args>(args)...
     );
 }
 
+template <typename Function, typename... Args>
+inline 
+observable_future<std::result_of_t<std::decay_t<Function>(std::decay_t<Args>...)>> 
+call_async(const pooled_t&, Function&& f, Args&&... args)
+{
+   using result_type = std::result_of_t<std::decay_t<Function>(std::decay_t<Args>...)>;
+
+   std::packaged_task<result_type(std::decay_t<Args>...)> pack {std::forward<Function>(f)};
+   auto cell = std::make_shared<ofis::completion_cell>();
+   observable_future<result_type> future {pack.get_future(),cell};
+
+#ifdef _MSC_VER
+   #pragma warning( push )
+   #pragma warning( disable: 4625 ) // '<lambda_...>': copy constructor was implicitly defined as deleted
+#endif
+
+   auto lambda = [p=std::move(pack),a=std::make_tuple(std::forward<Args>(args)...)]() mutable {
+      concurrency_token token {concurrency_governor::global(), std::try_to_lock};
+      thread_ex::apply(std::move(p),std::move(a));
+   };
+   default_thread_cache().execute(ofis::notifying<decltype(lambda)>{std::move(cell),std::move(lambda)});
+
+#ifdef _MSC_VER
+   #pragma warning( pop )
+#endif
+
+   return future;
+}
+
 template <typename Function, typename... Args>
 inline
 std::future<typename std::result_of<Function(Args...)>::type>
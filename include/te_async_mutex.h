@@ -0,0 +1,176 @@
+#ifndef _THREAD_EX_ASYNC_MUTEX_INCLUDED_
+#define _THREAD_EX_ASYNC_MUTEX_INCLUDED_
+
+/**
+	\file 	te_async_mutex.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_coroutine.h"
+
+#if defined(__cpp_impl_coroutine)
+
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <utility>
+#include <cassert>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_thread_pool.h"
+
+/**
+   \brief a mutex for coroutines: co_await m.scoped_lock() suspends the coroutine instead of blocking the worker
+
+   A contended std::mutex (block::lock) blocks the whole worker, the other coroutines queued to it wait as well.
+   - the state is one atomic word: unlocked, locked or the head of a lock-free list of the waiters pushed since the last unlock
+   - the owner moves the pushed waiters into its own FIFO list (no atomics) on unlock, the first one becomes the owner at once
+     and it is resumed on a worker of the pool given to the constructor (by the unlocking thread if there is none)
+   - there are no allocations, a waiter lives in the frame of its coroutine
+   co_await m.scoped_lock() returns async_mutex_lock which unlocks the mutex when it leaves the scope,
+   co_await m.lock() and unlock() are the manual way. The header is empty unless the compiler supports coroutines (-std=c++20).
+
+   \remark https://github.com/lewissbaker/cppcoro#async_mutex
+   \example unit/test_async_mutex.cpp
+*/
+
+namespace thread_ex
+{
+
+class async_mutex;
+
+   // the owner of a locked async_mutex, unlocks it in the destructor
+class async_mutex_lock
+{
+public:
+   explicit async_mutex_lock(async_mutex& m, std::adopt_lock_t) noexcept : mutex_(&m) {}
+   async_mutex_lock(async_mutex_lock&& other) noexcept : mutex_(std::exchange(other.mutex_, nullptr)) {}
+   async_mutex_lock(const async_mutex_lock&)              = delete;
+   async_mutex_lock& operator=(const async_mutex_lock&)   = delete;
+   ~async_mutex_lock();
+
+private:
+   async_mutex* mutex_;
+};
+
+class async_mutex
+{
+public:
+   class lock_awaiter
+   {
+   public:
+      explicit lock_awaiter(async_mutex& m) noexcept : mutex_(m) {}
+
+      bool  await_ready() const noexcept { return mutex_.try_lock(); }
+      bool  await_suspend(std::coroutine_handle<>) noexcept; // false - locked meanwhile, the coroutine goes on
+      void  await_resume() const noexcept {}
+
+   protected:
+      friend class async_mutex;
+      async_mutex&               mutex_;
+      std::coroutine_handle<>    handle_;
+      lock_awaiter*              next_ {nullptr};
+   };
+
+   class scoped_lock_awaiter : public lock_awaiter
+   {
+   public:
+      using lock_awaiter::lock_awaiter;
+      async_mutex_lock  await_resume() const noexcept { return async_mutex_lock{mutex_, std::adopt_lock}; }
+   };
+
+      // the waiters are resumed by the unlocking thread
+   async_mutex() = default;
+      // the waiters are resumed on the workers of 'pool'
+   explicit async_mutex(thread_pool& pool) noexcept : pool_(&pool) {}
+   ~async_mutex() { assert(not_locked==state_.load(std::memory_order_relaxed) && "async_mutex is destroyed while locked"); }
+   async_mutex(const async_mutex&)              = delete;
+   async_mutex& operator=(const async_mutex&)   = delete;
+
+   bool                 try_lock() noexcept;
+      // co_await m.lock(), unlock() is called by the owner
+   lock_awaiter         lock() noexcept         { return lock_awaiter{*this}; }
+      // co_await m.scoped_lock() -> async_mutex_lock
+   scoped_lock_awaiter  scoped_lock() noexcept  { return scoped_lock_awaiter{*this}; }
+   void                 unlock();
+
+private:
+      // state_ is 'not_locked', 'locked_no_waiters' or lock_awaiter* (the head of the pushed waiters, LIFO)
+   static constexpr std::uintptr_t not_locked         = 1;
+   static constexpr std::uintptr_t locked_no_waiters  = 0;
+
+   thread_pool*                  pool_    {nullptr};
+   std::atomic<std::uintptr_t>   state_   {not_locked};
+   lock_awaiter*                 waiters_ {nullptr};     // FIFO, owned by the owner of the mutex
+};
+
+inline
+async_mutex_lock::~async_mutex_lock()
+{
+   if(mutex_)
+      mutex_->unlock();
+}
+
+inline
+bool async_mutex::try_lock() noexcept
+{
+   std::uintptr_t expected = not_locked;
+   return state_.compare_exchange_strong(expected, locked_no_waiters, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+inline
+bool async_mutex::lock_awaiter::await_suspend(std::coroutine_handle<> h) noexcept
+{
+   handle_ = h;
+   std::uintptr_t old = mutex_.state_.load(std::memory_order_acquire);
+   for(;;)
+   {
+      if(not_locked==old)
+      {
+         if(mutex_.state_.compare_exchange_weak(old, locked_no_waiters, std::memory_order_acquire, std::memory_order_relaxed))
+            return false;
+      }
+      else
+      {
+         next_ = reinterpret_cast<lock_awaiter*>(old);
+         if(mutex_.state_.compare_exchange_weak(old, reinterpret_cast<std::uintptr_t>(this), std::memory_order_release, std::memory_order_relaxed))
+            return true;
+      }
+   }
+}
+
+inline
+void async_mutex::unlock()
+{
+   assert(not_locked!=state_.load(std::memory_order_relaxed));
+   lock_awaiter* w = waiters_;
+   if(!w)
+   {
+      std::uintptr_t expected = locked_no_waiters;
+      if(state_.compare_exchange_strong(expected, not_locked, std::memory_order_release, std::memory_order_relaxed))
+         return;
+         // the pushed waiters are taken, they are reversed into the FIFO order
+      std::uintptr_t pushed = state_.exchange(locked_no_waiters, std::memory_order_acquire);
+      assert(locked_no_waiters!=pushed && not_locked!=pushed);
+      for(lock_awaiter* p = reinterpret_cast<lock_awaiter*>(pushed); p; )
+      {
+         lock_awaiter* next = p->next_;
+         p->next_ = w;
+         w = p;
+         p = next;
+      }
+   }
+   waiters_ = w->next_;    // the mutex stays locked, 'w' is the owner
+   resume(pool_, w->handle_);
+}
+
+} // namespace thread_ex
+
+#endif // __cpp_impl_coroutine
+
+#endif //_THREAD_EX_ASYNC_MUTEX_INCLUDED_
@@ -0,0 +1,159 @@
+#ifndef _THREAD_EX_ASYNC_QUEUE_INCLUDED_
+#define _THREAD_EX_ASYNC_QUEUE_INCLUDED_
+
+/**
+	\file 	te_async_queue.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_coroutine.h"
+
+#if defined(__cpp_impl_coroutine)
+
+#include "te_compiler_warning_suppress.h"
+#include <coroutine>
+#include <optional>
+#include <queue>
+#include <mutex>
+#include <utility>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_thread_pool.h"
+
+/**
+   \brief threadsafe_queue for coroutines: co_await q.pop() suspends the coroutine instead of blocking the thread
+
+   threadsafe_queue::wait_pop parks a thread on a condition variable, a thread per waiting consumer.
+   - co_await q.pop() takes a stored value at once or queues the coroutine as a waiter (FIFO)
+   - push hands the value over to the first waiter: it is moved into the waiter straight away, it is not stored in the queue,
+     the waiter is resumed on a worker of the pool given to the constructor, by the pushing thread if there is none
+   - push and try_pop may be called by any thread, co_await q.pop() by coroutines only
+   A waiting coroutine must not be destroyed. The header is empty unless the compiler supports coroutines (-std=c++20).
+
+   \remark "C++ Coroutines: Understanding operator co_await", L. Baker
+   \remark https://github.com/lewissbaker/cppcoro#async_mutex (the same waiter list technique)
+   \example unit/test_async_queue.cpp
+*/
+
+namespace thread_ex
+{
+
+template <typename T>
+class async_queue
+{
+public:
+   using value_type = T;
+
+   class pop_awaiter
+   {
+   public:
+      explicit pop_awaiter(async_queue& q) noexcept : queue_(q) {}
+      pop_awaiter(const pop_awaiter&)              = delete;
+      pop_awaiter& operator=(const pop_awaiter&)   = delete;
+
+      bool  await_ready() const noexcept { return false; }
+      bool  await_suspend(std::coroutine_handle<>);     // false - a value is taken, the coroutine goes on
+      T     await_resume() { return std::move(*value_); }
+
+   private:
+      friend class async_queue;
+      async_queue&               queue_;
+      std::optional<T>           value_;
+      std::coroutine_handle<>    handle_;
+      pop_awaiter*               next_ {nullptr};
+   };
+
+      // the waiters are resumed by the pushing thread
+   async_queue() = default;
+      // the waiters are resumed on the workers of 'pool'
+   explicit async_queue(thread_pool& pool) noexcept : pool_(&pool) {}
+   async_queue(const async_queue&)              = delete;
+   async_queue& operator=(const async_queue&)   = delete;
+
+   void        push(T&& v)       { emplace(std::move(v)); }
+   void        push(const T& v)  { emplace(v); }
+      // co_await q.pop() -> T
+   pop_awaiter pop() noexcept    { return pop_awaiter{*this}; }
+   bool        try_pop(T& out);  // false returned if the queue is empty
+      // the values stored (no waiters meanwhile)
+   size_t      size() const;
+   bool        empty() const     { return 0==size(); }
+
+private:
+   template <typename V>
+   void        emplace(V&&);
+
+private:
+   thread_pool*         pool_ {nullptr};
+   mutable std::mutex   mutex_;
+   std::queue<T>        values_;             // guarded by mutex_, either values or waiters are there
+   pop_awaiter*         head_ {nullptr};     // guarded by mutex_
+   pop_awaiter*         tail_ {nullptr};     // guarded by mutex_
+};
+
+template <typename T>
+inline
+bool async_queue<T>::pop_awaiter::await_suspend(std::coroutine_handle<> h)
+{
+   std::lock_guard<std::mutex> l(queue_.mutex_);
+   if(!queue_.values_.empty())
+   {
+      value_.emplace(std::move(queue_.values_.front()));
+      queue_.values_.pop();
+      return false;
+   }
+   handle_ = h;
+   (queue_.tail_? queue_.tail_->next_ : queue_.head_) = this;
+   queue_.tail_ = this;
+   return true;
+}
+
+template <typename T>
+template <typename V>
+inline
+void async_queue<T>::emplace(V&& v)
+{
+   pop_awaiter* w {nullptr};
+   {  std::lock_guard<std::mutex> l(mutex_);
+      w = head_;
+      if(!w)
+      {
+         values_.push(std::forward<V>(v));
+         return;
+      }
+      if(!(head_ = w->next_))
+         tail_ = nullptr;
+   }
+   w->value_.emplace(std::forward<V>(v));   // the waiter is unlinked, nobody else touches it
+   resume(pool_, w->handle_);
+}
+
+template <typename T>
+inline
+bool async_queue<T>::try_pop(T& out)
+{
+   std::lock_guard<std::mutex> l(mutex_);
+   if(values_.empty())
+      return false;
+   out = std::move(values_.front());
+   values_.pop();
+   return true;
+}
+
+template <typename T>
+inline
+size_t async_queue<T>::size() const
+{
+   std::lock_guard<std::mutex> l(mutex_);
+   return values_.size();
+}
+
+} // namespace thread_ex
+
+#endif // __cpp_impl_coroutine
+
+#endif //_THREAD_EX_ASYNC_QUEUE_INCLUDED_
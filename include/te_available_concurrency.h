@@ -0,0 +1,293 @@
+#ifndef _THREAD_EX_AVAILABLE_CONCURRENCY_INCLUDED_
+#define _THREAD_EX_AVAILABLE_CONCURRENCY_INCLUDED_
+
+/**
+	\file 	te_available_concurrency.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <thread>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdlib>
+#include <cstddef>
+#include <algorithm>
+#ifdef _WIN32
+   #ifndef NOMINMAX
+      #define NOMINMAX
+   #endif
+   #include <windows.h>
+#elif defined(__linux__)
+   #include <sched.h>
+#endif
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+
+/**
+   \brief the number of threads the process can really run, std::thread::hardware_concurrency() is the number of CPUs of the host
+
+   Inside a container with a CPU quota of 4 on a 96 core host a pool of hardware_concurrency() workers is throttled by
+   the scheduler (CFS) as soon as they are busy together. detect_concurrency() is the least of
+   - std::thread::hardware_concurrency()
+   - the CPUs of the affinity mask of the process (sched_getaffinity, taskset, GetProcessAffinityMask)
+   - the CPU quota of cgroup v2 (cpu.max) or v1 (cpu.cfs_quota_us / cpu.cfs_period_us), rounded up,
+     the cgroup of the process (/proc/self/cgroup) and all its parents are taken into account
+   - the CPUs of cgroup cpuset (cpuset.cpus.effective of v2, cpuset.effective_cpus or cpuset.cpus of v1)
+   unless the environment variable THREAD_EX_CONCURRENCY is a positive number, then it is the result as is.
+   available_concurrency() is detected once per process, it is the default size of thread pools,
+   the default capacity of concurrency_governor and the upper limit of runtime_concurrency.
+
+   \remark https://docs.kernel.org/admin-guide/cgroup-v2.html#cpu-interface-files
+   \remark JDK-8146115 "Improve docker container detection and resource configuration usage"
+   \example unit/test_available_concurrency.cpp
+*/
+
+namespace thread_ex
+{
+
+   // where detect_concurrency reads the limits from
+struct concurrency_sources
+{
+   std::string environment  = "THREAD_EX_CONCURRENCY";   // empty - no override
+   std::string cgroup_root  = "/sys/fs/cgroup";          // empty - no cgroup limits
+   std::string proc_cgroup  = "/proc/self/cgroup";
+   bool        affinity     = true;
+};
+
+namespace cdis // concurrency_detector_internals
+{
+      // the first line of a file, empty if there is none
+   inline std::string read_line(const std::string& path)
+   {
+      std::ifstream file {path};
+      std::string line;
+      std::getline(file, line);
+      return line;
+   }
+
+      // a positive number, 0 - not a number
+   inline size_t to_number(const std::string& s)
+   {
+      char* end {nullptr};
+      const unsigned long long n = std::strtoull(s.c_str(), &end, 10);
+      return (!s.empty() && s[0]!='-' && end && '\0'==*end)? static_cast<size_t>(n) : 0;
+   }
+
+      // "0-3,8,10-11" -> {0,1,2,3,8,10,11}, empty if malformed
+   inline std::vector<size_t> parse_cpu_list(const std::string& list)
+   {
+      std::vector<size_t> cpus;
+      size_t pos {0};
+      while(pos < list.size())
+      {
+         size_t comma = list.find(',', pos);
+         if(std::string::npos==comma)
+            comma = list.size();
+         const std::string range = list.substr(pos, comma - pos);
+         const size_t dash = range.find('-');
+         if(std::string::npos==dash)
+         {
+            if(range.empty() || range.find_first_not_of("0123456789")!=std::string::npos)
+               return {};
+            cpus.push_back(static_cast<size_t>(std::strtoull(range.c_str(), nullptr, 10)));
+         }
+         else
+         {
+            const std::string from = range.substr(0, dash), to = range.substr(dash + 1);
+            if(from.empty() || to.empty() || (from + to).find_first_not_of("0123456789")!=std::string::npos)
+               return {};
+            const size_t f = static_cast<size_t>(std::strtoull(from.c_str(), nullptr, 10)), t = static_cast<size_t>(std::strtoull(to.c_str(), nullptr, 10));
+            if(t < f || t - f > 65535)    // more CPUs than Linux supports
+               return {};
+            for(size_t cpu = f; cpu <= t; ++cpu)
+               cpus.push_back(cpu);
+         }
+         pos = comma + 1;
+      }
+      return cpus;
+   }
+
+      // "0-3,8,10-11" -> 7, 0 - empty or malformed
+   inline size_t count_cpus(const std::string& list)
+   {
+      return parse_cpu_list(list).size();
+   }
+
+      // CPUs of 'quota' per 'period' rounded up, 0 - no quota
+   inline size_t quota_cpus(long long quota, long long period)
+   {
+      return (quota > 0 && period > 0)? static_cast<size_t>((quota + period - 1) / period) : 0;
+   }
+
+      // the least of two limits, 0 - no limit
+   inline size_t least(size_t a, size_t b)
+   {
+      return a && b? std::min(a, b) : (a? a : b);
+   }
+
+      // f(directory) of the cgroup 'path' under 'root' and all its parents up to 'root'
+   template <typename Function>
+   void for_each_level(const std::string& root, std::string path, Function f)
+   {
+      for(;;)
+      {
+         while(!path.empty() && '/'==path.back())
+            path.pop_back();
+         f(root + path);
+         if(path.empty())
+            return;
+         path.erase(path.rfind('/')==std::string::npos? 0 : path.rfind('/'));
+      }
+   }
+
+      // "max 100000" or "400000 100000"
+   inline size_t cpu_max(const std::string& line)
+   {
+      const size_t space = line.find(' ');
+      if(std::string::npos==space || 0==line.compare(0, space, "max"))
+         return 0;
+      return quota_cpus(std::atoll(line.c_str()), std::atoll(line.c_str() + space + 1));
+   }
+
+   inline size_t cgroup_v2(const std::string& root, const std::string& path)
+   {
+      size_t limit {0};
+      for_each_level(root, path, [&limit](const std::string& dir) {
+         limit = least(limit, cpu_max(read_line(dir + "/cpu.max")));
+         limit = least(limit, count_cpus(read_line(dir + "/cpuset.cpus.effective")));
+      });
+      return limit;
+   }
+
+   inline size_t cgroup_v1_cpu(const std::string& root, const std::string& path)
+   {
+      size_t limit {0};
+      for_each_level(root, path, [&limit](const std::string& dir) {
+         const std::string quota = read_line(dir + "/cpu.cfs_quota_us");
+         const std::string period = read_line(dir + "/cpu.cfs_period_us");
+         if(!quota.empty() && !period.empty())
+            limit = least(limit, quota_cpus(std::atoll(quota.c_str()), std::atoll(period.c_str())));
+      });
+      return limit;
+   }
+
+   inline size_t cgroup_v1_cpuset(const std::string& root, const std::string& path)
+   {
+      size_t limit {0};
+      for_each_level(root, path, [&limit](const std::string& dir) {
+         size_t cpus = count_cpus(read_line(dir + "/cpuset.effective_cpus"));
+         if(0==cpus)
+            cpus = count_cpus(read_line(dir + "/cpuset.cpus"));
+         limit = least(limit, cpus);
+      });
+      return limit;
+   }
+
+      // whether 'name' is one of the comma-separated 'controllers'
+   inline bool has_controller(const std::string& controllers, const std::string& name)
+   {
+      return std::string::npos!=(',' + controllers + ',').find(',' + name + ',');
+   }
+
+   inline size_t affinity()
+   {
+#if defined(_WIN32)
+      DWORD_PTR process {0}, system {0};
+      if(!::GetProcessAffinityMask(::GetCurrentProcess(), &process, &system))
+         return 0;
+      size_t count {0};
+      for(; process; process &= process - 1)
+         ++count;
+      return count;
+#elif defined(__linux__)
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      return 0==::sched_getaffinity(0, sizeof(set), &set)? static_cast<size_t>(CPU_COUNT(&set)) : 0;
+#else
+      return 0;
+#endif
+   }
+
+   inline size_t environment(const std::string& name)
+   {
+      if(name.empty())
+         return 0;
+#ifdef _MSC_VER
+   #pragma warning( push )
+   #pragma warning( disable: 4996 ) // 'getenv': This function or variable may be unsafe
+#endif
+      const char* value = std::getenv(name.c_str());
+#ifdef _MSC_VER
+   #pragma warning( pop )
+#endif
+      return value? to_number(value) : 0;
+   }
+}  // end of 'concurrency_detector_internals'
+
+/**
+   \brief the CPU limit of the cgroups of the process: the quota rounded up and the cpuset, 0 - there is no limit
+   'proc_cgroup' lists the cgroups of the process ("0::/path" of v2, "4:cpu,cpuacct:/path" and "7:cpuset:/path" of v1)
+*/
+inline size_t cgroup_concurrency(const std::string& cgroup_root, const std::string& proc_cgroup)
+{
+   if(cgroup_root.empty())
+      return 0;
+   std::ifstream file {proc_cgroup};
+   size_t limit {0};
+   for(std::string line; std::getline(file, line); )
+   {
+      const size_t first = line.find(':');
+      const size_t second = std::string::npos==first? first : line.find(':', first + 1);
+      if(std::string::npos==second)
+         continue;
+      const std::string controllers = line.substr(first + 1, second - first - 1);
+      const std::string path = line.substr(second + 1);
+      if(controllers.empty())
+         limit = cdis::least(limit, cdis::cgroup_v2(cgroup_root, path));
+      else
+      {
+         if(cdis::has_controller(controllers, "cpu"))
+         {
+            limit = cdis::least(limit, cdis::cgroup_v1_cpu(cgroup_root + "/" + controllers, path));
+            limit = cdis::least(limit, cdis::cgroup_v1_cpu(cgroup_root + "/cpu", path));
+         }
+         if(cdis::has_controller(controllers, "cpuset"))
+            limit = cdis::least(limit, cdis::cgroup_v1_cpuset(cgroup_root + "/cpuset", path));
+      }
+   }
+   return limit;
+}
+
+/**
+   \brief the number of threads the process can really run (at least 1), see the file description
+*/
+inline size_t detect_concurrency(const concurrency_sources& sources = concurrency_sources{})
+{
+   const size_t overridden = cdis::environment(sources.environment);
+   if(overridden)
+      return overridden;
+   size_t limit = std::thread::hardware_concurrency();
+   if(sources.affinity)
+      limit = cdis::least(limit, cdis::affinity());
+   limit = cdis::least(limit, cgroup_concurrency(sources.cgroup_root, sources.proc_cgroup));
+   return limit? limit : 1;
+}
+
+/**
+   \brief detect_concurrency() of the process, detected by the first call
+*/
+inline size_t available_concurrency()
+{
+   static const size_t detected = detect_concurrency();
+   return detected;
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_AVAILABLE_CONCURRENCY_INCLUDED_
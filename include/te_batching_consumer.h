@@ -0,0 +1,182 @@
+#ifndef _THREAD_EX_BATCHING_CONSUMER_INCLUDED_
+#define _THREAD_EX_BATCHING_CONSUMER_INCLUDED_
+
+/**
+	\file 	te_batching_consumer.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <utility>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_thread_unjoinable.h"
+
+/**
+   \brief a consumer thread handing the pushed elements over in batches: when 'threshold' of them are queued or
+   'max_delay' has passed since the oldest of them was pushed, whichever comes first
+
+   A loop around condition_wrap::wait_pop(container_type&) flushes whatever is queued at the moment it wakes up,
+   the consumer is woken up by every push and the swapped std::deque gives its buffers away. Here:
+   - a producer wakes the consumer up twice per batch at most: by the first element (the deadline starts) and by the 'threshold'-th one
+   - the batch is a std::vector, contiguous, e.g. for one write(2) of the whole batch
+   - there are two buffers swapped between the producers and the consumer, they keep their capacity (reserved up front),
+     so there are no allocations in the steady state unless a batch is bigger than the reserved capacity
+   'max_delay' of duration_type::max() means no deadline, the batches are handed over by the size threshold (or 'flush') only.
+   The handler may move the elements out of the batch, the batch is cleared after the handler returns. The handler must not throw.
+   The destructor hands the queued elements over (no matter the threshold and the deadline) and joins the consumer.
+
+   \remark "Designing Data-Intensive Applications", M. Kleppmann, ch. 11 (micro-batching)
+   \remark https://www.postgresql.org/docs/current/wal-async-commit.html (group commit)
+   \example unit/test_batching_consumer.cpp
+*/
+
+namespace thread_ex
+{
+
+template <typename T>
+class batching_consumer
+{
+   using this_type         = batching_consumer<T>;
+   using unique_lock_type  = std::unique_lock<std::mutex>;
+   using lock_guard_type   = std::lock_guard<std::mutex>;
+   using clock_type        = std::chrono::steady_clock;
+
+public:
+   using value_type     = T;
+   using buffer_type    = std::vector<T>;
+   using duration_type  = clock_type::duration;
+
+      // h(buffer_type&) handles a batch on the consumer thread,
+      // 'reserve' - the initial capacity of both buffers (the threshold if zero)
+   template <typename Handler>
+   batching_consumer(Handler&& h, size_t threshold, duration_type max_delay, size_t reserve = 0);
+   ~batching_consumer();
+   batching_consumer(const this_type&)             = delete;
+   this_type& operator=(const this_type&)          = delete;
+
+   void     push(T&& v)       { emplace(std::move(v)); }
+   void     push(const T& v)  { emplace(v); }
+      // the queued elements are handed over at once, no matter the threshold and the deadline
+   void     flush();
+      // the elements queued and not handed over yet
+   size_t   size() const;
+
+private:
+   static buffer_type reserved(size_t n) { buffer_type b; b.reserve(n); return b; }
+   template <typename V>
+   void     emplace(V&&);
+   void     consume();
+
+private:
+   std::function<void(buffer_type&)>   handler_;
+   const size_t                        threshold_;
+   const duration_type                 max_delay_;
+   mutable std::mutex                  mutex_;
+   std::condition_variable             cond_;
+   buffer_type                         incoming_;     // guarded by mutex_
+   clock_type::time_point              first_at_;     // when the oldest of 'incoming_' was pushed, guarded by mutex_
+   bool                                flush_ {false};      // guarded by mutex_
+   bool                                stopping_ {false};   // guarded by mutex_
+   buffer_type                         batch_;        // owned by the consumer
+   joined_thread                       consumer_;     // the last one: it is started when the rest is ready
+};
+
+template <typename T>
+template <typename Handler>
+inline
+batching_consumer<T>::batching_consumer(Handler&& h, size_t threshold, duration_type max_delay, size_t reserve)
+   : handler_(std::forward<Handler>(h))
+   , threshold_(threshold?threshold:1)
+   , max_delay_(max_delay)
+   , incoming_(reserved(reserve?reserve:threshold_))
+   , batch_(reserved(reserve?reserve:threshold_))
+   , consumer_(std::thread{&this_type::consume, this})
+{
+}
+
+template <typename T>
+inline
+batching_consumer<T>::~batching_consumer()
+{
+   {  lock_guard_type l(mutex_);
+      stopping_ = true;
+   }
+   cond_.notify_one();
+}
+
+template <typename T>
+template <typename V>
+inline
+void batching_consumer<T>::emplace(V&& v)
+{
+   bool wake {false};
+   {  lock_guard_type l(mutex_);
+      if(incoming_.empty())
+      {
+         first_at_ = clock_type::now();
+         wake = true;
+      }
+      incoming_.push_back(std::forward<V>(v));
+      wake = wake || threshold_==incoming_.size();
+   }
+   if(wake)
+      cond_.notify_one();
+}
+
+template <typename T>
+inline
+void batching_consumer<T>::flush()
+{
+   {  lock_guard_type l(mutex_);
+      if(incoming_.empty())
+         return;     // nothing to flush, the next batch is not hurried
+      flush_ = true;
+   }
+   cond_.notify_one();
+}
+
+template <typename T>
+inline
+size_t batching_consumer<T>::size() const
+{
+   lock_guard_type l(mutex_);
+   return incoming_.size();
+}
+
+template <typename T>
+inline
+void batching_consumer<T>::consume()
+{
+   unique_lock_type l(mutex_);
+   for(;;)
+   {
+      cond_.wait(l, [this] { return stopping_ || !incoming_.empty(); });
+      if(incoming_.empty())
+         return;     // stopping, nothing left
+      const auto handed_over = [this] { return stopping_ || flush_ || incoming_.size() >= threshold_; };
+      if(max_delay_ > clock_type::time_point::max() - first_at_)
+         cond_.wait(l, handed_over);   // the deadline is out of the clock, e.g. duration_type::max(): the size threshold only
+      else
+         cond_.wait_until(l, first_at_ + max_delay_, handed_over);
+      flush_ = false;
+      incoming_.swap(batch_);    // the producers get the buffer of the previous batch, empty but with its capacity
+      l.unlock();
+      handler_(batch_);
+      batch_.clear();
+      l.lock();
+   }
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_BATCHING_CONSUMER_INCLUDED_
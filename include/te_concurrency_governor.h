@@ -0,0 +1,188 @@
+#ifndef _THREAD_EX_CONCURRENCY_GOVERNOR_INCLUDED_
+#define _THREAD_EX_CONCURRENCY_GOVERNOR_INCLUDED_
+
+/**
+	\file 	te_concurrency_governor.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstddef>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_available_concurrency.h"
+
+/**
+   \brief a process-wide budget of running threads shared by the governed thread pools, call_async and runtime_concurrency
+
+   Every thread pool sized by available_concurrency() is fine on its own,
+   but as soon as several independent components create their own pools the machine is oversubscribed.
+   The governor hands out 'tokens', one per running worker. A worker owns a token only while it has work to do
+   and gives it back before it goes idle, so a busy pool can run on the capacity an idle pool is not using at the moment.
+   The total number of running workers therefore tracks the capacity (available_concurrency() by default)
+   rather than the sum of all pool sizes. A pool runs under a governor if it is told so (thread_pool::govern).
+
+   \remark "C++ Concurrency in Action", Anthony Williams, chapter 8.2.4 (oversubscription and excessive task switching)
+   \example unit/test_concurrency_governor.cpp
+*/
+
+namespace thread_ex
+{
+
+class concurrency_governor
+{
+public:
+   explicit concurrency_governor(size_t capacity = available_concurrency());
+   concurrency_governor(const concurrency_governor&)              = delete;
+   concurrency_governor& operator=(const concurrency_governor&)   = delete;
+
+      // the instance shared by all thread pools and call_async in the process
+   static concurrency_governor& global();
+
+   void     acquire();                    // waits (if needed) until a token is available
+   bool     try_acquire() noexcept;       // 'false' returned if there is no free token at the moment
+   void     release();
+      // gives the token away for a moment if somebody is waiting for it, then takes a token again
+   void     yield();
+
+   size_t   capacity() const noexcept;
+   size_t   available() const noexcept;   // 0 if all tokens are in use (or the governor is oversubscribed)
+   void     set_capacity(size_t);         // tokens in use are not revoked, the new capacity is reached as they are released
+
+private:
+   std::atomic<std::ptrdiff_t>   available_;
+   std::atomic<size_t>           capacity_;
+   std::atomic<size_t>           waiters_    {0};
+   std::mutex                    mutex_;
+   std::condition_variable       cond_;
+};
+
+/**
+   \brief RAII owner of a single token of concurrency_governor, the vocabulary is borrowed from std::unique_lock
+*/
+class concurrency_token
+{
+public:
+   concurrency_token() = default;
+   explicit concurrency_token(concurrency_governor& g)                  : governor_(&g) { g.acquire(); }
+   concurrency_token(concurrency_governor& g, const std::try_to_lock_t&) : governor_(g.try_acquire()? &g : nullptr) {}
+   concurrency_token(concurrency_token&& other) noexcept                 : governor_(other.governor_) { other.governor_ = nullptr; }
+   concurrency_token& operator=(concurrency_token&& other) noexcept
+   {
+      if(this != &other)
+      {
+         release();
+         governor_ = other.governor_;
+         other.governor_ = nullptr;
+      }
+      return *this;
+   }
+   concurrency_token(const concurrency_token&)              = delete;
+   concurrency_token& operator=(const concurrency_token&)   = delete;
+   ~concurrency_token() { release(); }
+
+   bool owns_token() const noexcept { return nullptr!=governor_; }
+   void release()
+   {
+      if(governor_)
+         governor_->release();
+      governor_ = nullptr;
+   }
+
+private:
+   concurrency_governor* governor_ {nullptr};
+};
+
+inline
+concurrency_governor::concurrency_governor(size_t capacity)
+   : available_(static_cast<std::ptrdiff_t>(capacity?capacity:1))
+   , capacity_(capacity?capacity:1)
+{
+}
+
+inline
+concurrency_governor& concurrency_governor::global()
+{
+   static concurrency_governor the_governor;
+   return the_governor;
+}
+
+inline
+bool concurrency_governor::try_acquire() noexcept
+{
+   std::ptrdiff_t n = available_.load();
+   while(n > 0)
+   {
+      if(available_.compare_exchange_weak(n, n-1, std::memory_order_acquire, std::memory_order_relaxed))
+         return true;
+   }
+   return false;
+}
+
+inline
+void concurrency_governor::acquire()
+{
+   if(try_acquire())
+      return;
+
+   std::unique_lock<std::mutex> l(mutex_);
+   ++waiters_;
+   cond_.wait(l, [this] { return try_acquire(); });
+   --waiters_;
+}
+
+inline
+void concurrency_governor::release()
+{
+   available_.fetch_add(1);
+   if(waiters_.load())
+   {
+      std::lock_guard<std::mutex> l(mutex_);
+      cond_.notify_one();
+   }
+}
+
+inline
+void concurrency_governor::yield()
+{
+   if(!waiters_.load(std::memory_order_relaxed))
+      return;
+   release();
+   std::this_thread::yield();
+   acquire();
+}
+
+inline
+size_t concurrency_governor::capacity() const noexcept
+{
+   return capacity_.load(std::memory_order_relaxed);
+}
+
+inline
+size_t concurrency_governor::available() const noexcept
+{
+   const std::ptrdiff_t n = available_.load(std::memory_order_relaxed);
+   return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+inline
+void concurrency_governor::set_capacity(size_t n)
+{
+   n = n?n:1;
+   const size_t old = capacity_.exchange(n);
+   available_.fetch_add(static_cast<std::ptrdiff_t>(n) - static_cast<std::ptrdiff_t>(old));
+   std::lock_guard<std::mutex> l(mutex_);
+   cond_.notify_all();
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_CONCURRENCY_GOVERNOR_INCLUDED_
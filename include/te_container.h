@@ -16,11 +16,14 @@
 #include <mutex>
 #include <condition_variable>
 #include <utility>
+#include <algorithm>
+#include <cassert>
 #include "te_compiler_warning_rollback.h"
 #include "te_compiler.h"
 #include "te_lock_unique_pair.h"
 #include "te_pop.h"
 #include "te_block_lock.h"
+#include "te_stop_token.h"
 
 
 /**
@@ -78,6 +81,9 @@ public:
    void              pop(container_type& out);                 // throw (empty_error);
    bool              pop(std::nothrow_t, value_type& out);     // false returned if the container is empty
    bool              pop(std::nothrow_t, container_type& out); // all elements are moved into out and 'true' returned, 'false' if empty
+      // up to 'max_count' elements, but no more than 1/'share' (rounded up) of the stored ones, are moved into 'out'
+      // returns the number of moved elements, 0 if empty
+   size_type         pop(std::nothrow_t, container_type& out, size_type max_count, size_type share = 1);
 
    void              swap(this_type& other);
    void              swap(container_type& other);
@@ -90,6 +96,21 @@ public:
 }; // class mutex_wrap
 
 
+   // the condition variable of condition_wrap waiting with std::unique_lock<MUTEX_T>.
+   // a mutex which blocks in its own way specializes it (e.g. fiber_mutex, see te_fiber.h)
+template <typename MUTEX_T>
+struct condition_of
+{
+   using type = std::condition_variable_any;
+};
+
+template <>
+struct condition_of<std::mutex>
+{
+   using type = std::condition_variable;
+};
+
+
 template
 <
     typename VALUE_T
@@ -100,11 +121,22 @@ class condition_wrap : mutex_wrap<VALUE_T, STL_CONTAINER_T, MUTEX_T>
 {
    using base_type         = mutex_wrap<VALUE_T, STL_CONTAINER_T, MUTEX_T>;
    using this_type         = condition_wrap<VALUE_T, STL_CONTAINER_T, MUTEX_T>;
-   using condition_type    = std::condition_variable;
+   using condition_type    = typename condition_of<MUTEX_T>::type;
    using unique_lock_type  = typename base_type::unique_lock_type;
+   using lock_guard_type   = typename base_type::lock_guard_type;
+
+      // wakes up the waiting consumers when a stop is requested
+   struct stop_waker
+   {
+      this_type* self;
+      void operator()() const noexcept { { lock_guard_type l(self->mutex_); } self->cond_.notify_all(); }
+   };
+   using stop_callback_type = stop_callback<stop_waker>;
 
    condition_type cond_;
 
+   bool              wait(unique_lock_type&, const stop_token&);  // 'false' - a stop is requested and the container is empty
+
 public:
    using container_type    = typename base_type::container_type;
    using value_type        = typename base_type::value_type;
@@ -128,10 +160,18 @@ public:
    void              try_pop(container_type& out);                // throw (empty_error);
    bool              try_pop(std::nothrow_t, value_type& out);    // false returned if the container is empty
    bool              try_pop(std::nothrow_t, container_type& out);// all elements are moved into out and 'true' returned, 'false' if empty
+   size_type         try_pop(std::nothrow_t, container_type& out, size_type max_count, size_type share = 1); // a batch of elements, see mutex_wrap::pop
 
    ptr_value_type    wait_pop();                                  // if the container is empty, it waits until an element is pushed by other thread 
    void              wait_pop(value_type& out);                   // waits (if needed) and pops one element
    void              wait_pop(container_type& out);               // waits (if needed) and pops all elements
+      // waits (if needed) and pops a batch: up to 'max_count' elements, but no more than 1/'share' (rounded up) of the stored ones
+      // e.g. 'share' is the number of consumers, so a batch does not leave the other consumers without elements
+   size_type         wait_pop(container_type& out, size_type max_count, size_type share = 1);
+      // the same waits interrupted by a stop request (see te_stop_token.h), 'false' (0) is returned if nothing has been popped
+   bool              wait_pop(value_type& out, const stop_token&);
+   bool              wait_pop(container_type& out, const stop_token&);
+   size_type         wait_pop(container_type& out, size_type max_count, size_type share, const stop_token&);
 
    void              swap(this_type& other);
    using             base_type::empty;
@@ -301,6 +341,18 @@ mutex_wrap<V,C,M>::pop(std::nothrow_t, container_type& out)
    return true;
 }
 
+template <typename V, typename C, typename M>
+inline
+typename mutex_wrap<V,C,M>::size_type
+mutex_wrap<V,C,M>::pop(std::nothrow_t, container_type& out, size_type max_count, size_type share)
+{
+   assert(max_count && "a batch of zero elements");
+   share = share?share:1;
+   lock_guard_type l(mutex_);
+   const size_type fair = (container_.size() + share - 1) / share;
+   return thread_ex::pop(container_, out, std::min(max_count, fair));
+}
+
 template <typename V, typename C, typename M>
 inline
 void
@@ -458,6 +510,14 @@ condition_wrap<V,C,M>::try_pop(std::nothrow_t n, container_type& out)
    return base_type::pop(n, out);
 }
 
+template <typename V, typename C, typename M>
+inline
+typename condition_wrap<V,C,M>::size_type
+condition_wrap<V,C,M>::try_pop(std::nothrow_t n, container_type& out, size_type max_count, size_type share)
+{
+   return base_type::pop(n, out, max_count, share);
+}
+
 template <typename V, typename C, typename M>
 inline
 void
@@ -493,6 +553,74 @@ condition_wrap<V,C,M>::wait_pop(container_type& out)
    out.swap(cont);
 }
 
+template <typename V, typename C, typename M>
+inline
+typename condition_wrap<V,C,M>::size_type
+condition_wrap<V,C,M>::wait_pop(container_type& out, size_type max_count, size_type share)
+{
+   assert(max_count && "a batch of zero elements");
+   share = share?share:1;
+   unique_lock_type l(base_type::mutex_);
+   container_type& cont =  base_type::container_;
+   if (cont.empty())
+      cond_.wait(l, [&cont] { return !cont.empty(); });
+   const size_type fair = (cont.size() + share - 1) / share;
+   return thread_ex::pop(cont, out, std::min(max_count, fair));
+}
+
+template <typename V, typename C, typename M>
+inline
+bool
+condition_wrap<V,C,M>::wait(unique_lock_type& l, const stop_token& token)
+{
+   container_type& cont =  base_type::container_;
+   if (cont.empty())
+      cond_.wait(l, [&cont,&token] { return !cont.empty() || token.stop_requested(); });
+   return !cont.empty();
+}
+
+template <typename V, typename C, typename M>
+inline
+bool
+condition_wrap<V,C,M>::wait_pop(value_type& out, const stop_token& token)
+{
+   stop_callback_type waker {token, stop_waker{this}};   // registered out of the lock, it takes the lock itself
+   unique_lock_type l(base_type::mutex_);
+   if (!wait(l, token))
+      return false;
+   thread_ex::pop<first_element>(base_type::container_,out);
+   return true;
+}
+
+template <typename V, typename C, typename M>
+inline
+bool
+condition_wrap<V,C,M>::wait_pop(container_type& out, const stop_token& token)
+{
+   stop_callback_type waker {token, stop_waker{this}};
+   unique_lock_type l(base_type::mutex_);
+   if (!wait(l, token))
+      return false;
+   out.swap(base_type::container_);
+   return true;
+}
+
+template <typename V, typename C, typename M>
+inline
+typename condition_wrap<V,C,M>::size_type
+condition_wrap<V,C,M>::wait_pop(container_type& out, size_type max_count, size_type share, const stop_token& token)
+{
+   assert(max_count && "a batch of zero elements");
+   share = share?share:1;
+   stop_callback_type waker {token, stop_waker{this}};
+   unique_lock_type l(base_type::mutex_);
+   if (!wait(l, token))
+      return 0;
+   container_type& cont =  base_type::container_;
+   const size_type fair = (cont.size() + share - 1) / share;
+   return thread_ex::pop(cont, out, std::min(max_count, fair));
+}
+
 template <typename V, typename C, typename M>
 inline
 void
@@ -0,0 +1,76 @@
+#ifndef _THREAD_EX_COROUTINE_INCLUDED_
+#define _THREAD_EX_COROUTINE_INCLUDED_
+
+/**
+	\file 	te_coroutine.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#if defined(__cpp_impl_coroutine)
+
+#include "te_compiler_warning_suppress.h"
+#include <coroutine>
+#include <exception>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_thread_pool.h"
+
+/**
+   \brief the glue between C++20 coroutines and thread_pool, used by the awaitable primitives (async_queue, async_mutex)
+
+   - resume(pool, h) resumes the coroutine on a worker of the pool, by the calling thread if there is no pool
+   - co_await resume_on(pool) moves the coroutine on a worker of the pool
+   - detached_task is the return type of a fire-and-forget coroutine: it starts at once and frees its frame when it is done,
+     an exception leaving it terminates the program as it does for std::thread
+   The header is empty unless the compiler supports coroutines (-std=c++20).
+
+   \remark https://en.cppreference.com/w/cpp/language/coroutines
+   \example unit/test_async_queue.cpp
+*/
+
+namespace thread_ex
+{
+
+inline
+void resume(thread_pool* pool, std::coroutine_handle<> h)
+{
+   if(pool)
+      pool->post([h] { h.resume(); });
+   else
+      h.resume();
+}
+
+class resume_on
+{
+public:
+   explicit resume_on(thread_pool& pool) noexcept : pool_(pool) {}
+
+   bool  await_ready() const noexcept           { return false; }
+   void  await_suspend(std::coroutine_handle<> h) { resume(&pool_, h); }
+   void  await_resume() const noexcept          {}
+
+private:
+   thread_pool& pool_;
+};
+
+struct detached_task
+{
+   struct promise_type
+   {
+      detached_task        get_return_object() noexcept  { return {}; }
+      std::suspend_never   initial_suspend() noexcept    { return {}; }
+      std::suspend_never   final_suspend() noexcept      { return {}; }
+      void                 return_void() noexcept        {}
+      void                 unhandled_exception() noexcept { std::terminate(); }
+   };
+};
+
+} // namespace thread_ex
+
+#endif // __cpp_impl_coroutine
+
+#endif //_THREAD_EX_COROUTINE_INCLUDED_
@@ -0,0 +1,36 @@
+#ifndef _THREAD_EX_EXPIRED_ERROR_INCLUDED_
+#define _THREAD_EX_EXPIRED_ERROR_INCLUDED_
+
+/**
+	\file 		te_expired_error.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11) 
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <stdexcept>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+
+
+/**
+	\brief  	exception 'deadline expired', a task was discarded by thread_pool without running since its deadline had passed
+*/
+
+
+namespace thread_ex
+{
+
+   struct expired_error : std::runtime_error
+   {
+               expired_error()                       : std::runtime_error("expired error") {}
+      explicit expired_error(const char* msg)        : std::runtime_error(msg) {}
+      explicit expired_error(const std::string& msg) : std::runtime_error(msg) {}
+   };
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_EXPIRED_ERROR_INCLUDED_
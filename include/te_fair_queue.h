@@ -0,0 +1,209 @@
+#ifndef _THREAD_EX_FAIR_QUEUE_INCLUDED_
+#define _THREAD_EX_FAIR_QUEUE_INCLUDED_
+
+/**
+	\file 	te_fair_queue.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <queue>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+#include <new>
+#include <cassert>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+
+/**
+   \brief a queue with no race conditions shared by several tenants, the elements are popped by deficit round-robin
+
+   A plain FIFO is not fair: a tenant which has pushed 100k elements delays everybody pushed after it.
+   fair_queue keeps a sub-queue per tenant and the active tenants take turns, a tenant pops up to its weight of elements per turn.
+   A tenant with a few elements waits at most one round, no matter how long the queues of the others are.
+   The queue is work-conserving: when only one tenant has elements, all of them are popped one after another.
+
+   The sub-queue of a tenant is kept after it gets empty, the tenants are expected to be a few long-living ones (features, clients).
+
+   \remark M. Shreedhar, G. Varghese "Efficient Fair Queuing Using Deficit Round-Robin", 1996 (all elements are of the unit cost)
+   \example unit/test_fair_queue.cpp
+*/
+
+namespace thread_ex
+{
+
+template
+<
+    typename VALUE_T
+   ,typename MUTEX_T     = std::mutex
+>
+class fair_queue
+{
+public:
+   using  container_type   = std::queue<VALUE_T>;
+   using  size_type        = typename container_type::size_type;
+   using  value_type       = VALUE_T;
+   using  tenant_type      = size_t;
+
+   fair_queue()                                 = default;
+   fair_queue(const fair_queue&)                = delete;
+   fair_queue& operator=(const fair_queue&)     = delete;
+
+      // the number of elements a tenant pops per turn, 1 by default
+   void              set_weight(tenant_type, size_type);
+   void              push(tenant_type, value_type&&);
+   void              push(tenant_type, const value_type&);
+
+   bool              pop(std::nothrow_t, value_type& out);     // false returned if the queue is empty
+      // up to 'max_count' elements but no more than 1/share of the queued ones, see mutex_wrap::pop
+   size_type         pop(std::nothrow_t, container_type& out, size_type max_count, size_type share = 1);
+
+   bool              empty() const;
+   size_type         size() const;
+
+private:
+   struct tenant_queue
+   {
+      container_type elements;
+      size_type      weight   {1};
+      size_type      deficit  {0};  // elements left to pop in the current turn
+      bool           active   {false};
+   };
+   using lock_guard_type = std::lock_guard<MUTEX_T>;
+
+   void              activate(tenant_queue&);
+   value_type        pop_locked();
+
+private:
+   mutable MUTEX_T                                 mutex_;
+   std::unordered_map<tenant_type, tenant_queue>   tenants_;
+   std::deque<tenant_queue*>                       round_;     // the tenants which have elements, the front one has the turn
+   size_type                                       size_    {0};
+};
+
+template <typename V, typename M>
+inline
+void
+fair_queue<V,M>::set_weight(tenant_type t, size_type weight)
+{
+   lock_guard_type l(mutex_);
+   tenants_[t].weight = weight? weight : 1;
+}
+
+template <typename V, typename M>
+inline
+void
+fair_queue<V,M>::activate(tenant_queue& q)
+{
+   if(!q.active)
+   {
+      round_.push_back(&q);
+      q.active  = true;
+      q.deficit = 0;
+   }
+   ++size_;
+}
+
+template <typename V, typename M>
+inline
+void
+fair_queue<V,M>::push(tenant_type t, value_type&& v)
+{
+   lock_guard_type l(mutex_);
+   tenant_queue& q = tenants_[t];
+   q.elements.push(std::move(v));
+   activate(q);
+}
+
+template <typename V, typename M>
+inline
+void
+fair_queue<V,M>::push(tenant_type t, const value_type& v)
+{
+   lock_guard_type l(mutex_);
+   tenant_queue& q = tenants_[t];
+   q.elements.push(v);
+   activate(q);
+}
+
+template <typename V, typename M>
+inline
+typename fair_queue<V,M>::value_type
+fair_queue<V,M>::pop_locked()
+{
+   assert(!round_.empty());
+   tenant_queue& q = *round_.front();
+   if(0==q.deficit)
+      q.deficit = q.weight;   // a new turn of the tenant
+   value_type v {std::move(q.elements.front())};
+   q.elements.pop();
+   --q.deficit;
+   --size_;
+   if(q.elements.empty())
+   {
+      q.active  = false;
+      q.deficit = 0;
+      round_.pop_front();
+   }
+   else if(0==q.deficit)
+   {
+      round_.pop_front();
+      round_.push_back(&q);
+   }
+   return v;
+}
+
+template <typename V, typename M>
+inline
+bool
+fair_queue<V,M>::pop(std::nothrow_t, value_type& out)
+{
+   lock_guard_type l(mutex_);
+   if(!size_)
+      return false;
+   out = pop_locked();
+   return true;
+}
+
+template <typename V, typename M>
+inline
+typename fair_queue<V,M>::size_type
+fair_queue<V,M>::pop(std::nothrow_t, container_type& out, size_type max_count, size_type share)
+{
+   assert(max_count && "a batch of zero elements");
+   share = share?share:1;
+   lock_guard_type l(mutex_);
+   const size_type n = std::min(max_count, (size_ + share - 1) / share);
+   for(size_type i = 0; i < n; ++i)
+      out.push(pop_locked());
+   return n;
+}
+
+template <typename V, typename M>
+inline
+bool
+fair_queue<V,M>::empty() const
+{
+   lock_guard_type l(mutex_);
+   return 0==size_;
+}
+
+template <typename V, typename M>
+inline
+typename fair_queue<V,M>::size_type
+fair_queue<V,M>::size() const
+{
+   lock_guard_type l(mutex_);
+   return size_;
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_FAIR_QUEUE_INCLUDED_
@@ -0,0 +1,504 @@
+#ifndef _THREAD_EX_FIBER_INCLUDED_
+#define _THREAD_EX_FIBER_INCLUDED_
+
+/**
+	\file 	te_fiber.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#if defined(_WIN32)
+   #error "te_fiber.h: the fibers are based on ucontext, POSIX only"
+#endif
+
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <system_error>
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <cerrno>
+#include <cassert>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_container.h"
+#include "te_thread_pool.h"
+
+/**
+   \brief stackful fibers run by the workers of a thread_pool, they are suspended instead of blocking the worker
+
+   A legacy code path blocking deep in its call stack cannot be turned into a coroutine, run by a thread_pool task it pins the worker.
+   Run by a fiber (fiber_executor::spawn) it has its own stack and:
+   - fiber_mutex, fiber_condition_variable and fiber_queue (threadsafe_queue of fiber_mutex) suspend the fiber,
+     the worker goes on with the other tasks, the fiber is posted back to the pool when it is woken up
+   - a suspended fiber may be resumed by another worker
+   - they block a plain thread as std::mutex & std::condition_variable do, so the threads and the fibers can share them
+   - the stacks are small (64 KiB by default) with a guard page, mmap'ed once and reused by the next fibers of the executor
+   Thousands of blocked logical tasks cost their stacks, not the workers.
+
+   A fiber must not keep the identity of the thread across a suspension (thread_local, std::mutex, blocking_section),
+   a std::mutex and any other blocking call still block the worker. The context switch is swapcontext (x86-64, aarch64 and others).
+
+   \remark "Fibers under the magnifying glass", G. Nishanov, P1364R0
+   \remark https://www.boost.org/doc/libs/release/libs/fiber/doc/html/index.html
+   \example unit/test_fiber.cpp
+*/
+
+namespace thread_ex
+{
+
+class fiber_executor;
+
+namespace fbis // fiber_internals
+{
+   struct job
+   {
+      virtual void run() = 0;
+      virtual ~job() {}
+   };
+
+   template <typename Function>
+   struct job_impl : job
+   {
+      explicit job_impl(Function&& f) : f_(std::move(f)) {}
+      void run() override { f_(); }
+      Function f_;
+   };
+
+   struct fiber
+   {
+      ucontext_t              context;
+      void*                   memory {nullptr};    // a guard page and the stack
+      size_t                  memory_size {0};
+      size_t                  guard_size {0};
+      std::unique_ptr<job>    work;
+      thread_pool*            pool {nullptr};
+      fiber_executor*         owner {nullptr};
+      bool                    done {false};
+
+      fiber() = default;
+      fiber(const fiber&)              = delete;
+      fiber& operator=(const fiber&)   = delete;
+      ~fiber() { if(memory) munmap(memory, memory_size); }
+   };
+
+   struct current_type
+   {
+      fiber*         running;       // null - not a fiber
+      ucontext_t*    worker;        // the context the fiber is switched back to
+      void           (*after)(void*);  // run by the worker once the fiber is switched out
+      void*          after_arg;
+   };
+
+      // not inlined and not CSE'd: a suspended fiber may be resumed by another thread,
+      // the address of a thread_local variable must not be kept across a switch
+   __attribute__((noinline))
+   inline current_type& current() noexcept
+   {
+      static thread_local current_type c;
+      asm volatile("" ::: "memory");
+      return c;
+   }
+
+   inline void resume(fiber*) noexcept;
+
+   inline void entry()
+   {
+      fiber* f = current().running;
+      f->work->run();      // a std::packaged_task, it does not throw
+      f->work.reset();     // destroyed on its own stack
+      f->done = true;
+      swapcontext(&f->context, current().worker);    // never returns
+   }
+
+      // a fresh context of 'f' on its own stack, a function of its own: nothing of the caller is live across getcontext
+   __attribute__((noinline))
+   inline void prepare(fiber* f) noexcept
+   {
+      getcontext(&f->context);
+      f->context.uc_stack.ss_sp     = static_cast<char*>(f->memory) + f->guard_size;
+      f->context.uc_stack.ss_size   = f->memory_size - f->guard_size;
+      f->context.uc_link            = nullptr;
+      makecontext(&f->context, &entry, 0);
+      f->done = false;
+   }
+
+   inline void suspend(void (*after)(void*), void* arg) noexcept
+   {
+      current_type& c = current();
+      c.after     = after;
+      c.after_arg = arg;
+      swapcontext(&c.running->context, c.worker);
+   }
+
+   inline void wake(fiber* f)
+   {
+      f->pool->post([f] { resume(f); });
+   }
+
+      // a fiber or a thread blocked on fiber_mutex or fiber_condition_variable, it lives on the stack of the blocked one
+   struct waiter
+   {
+      fiber* const            suspended {current().running};  // null - a thread
+      waiter*                 next {nullptr};
+      std::mutex              mutex;      // a thread waits for 'woken' with them
+      std::condition_variable cond;
+      bool                    woken {false};
+   };
+
+   struct waiter_list
+   {
+      waiter*  head {nullptr};
+      waiter*  tail {nullptr};
+
+      void     push(waiter* w) noexcept   { (tail? tail->next : head) = w; tail = w; }
+      waiter*  pop() noexcept             { waiter* w = head; if(w && !(head = w->next)) tail = nullptr; return w; }
+      waiter*  take_all() noexcept        { waiter* w = head; head = tail = nullptr; return w; }
+   };
+
+      // 'guard' protects the list 'w' is linked to, it is unlocked when the fiber is switched out
+      // (a wake cannot resume the fiber still running), the caller gets it unlocked
+   inline void park(waiter& w, std::unique_lock<std::mutex>& guard)
+   {
+      if(w.suspended)
+      {
+         suspend([](void* m) { static_cast<std::mutex*>(m)->unlock(); }, guard.release());
+         return;
+      }
+      std::unique_lock<std::mutex> l(w.mutex);
+      guard.unlock();
+      w.cond.wait(l, [&w] { return w.woken; });
+   }
+
+   inline void wake(waiter& w)
+   {
+      if(fiber* f = w.suspended)
+         return wake(f);
+      std::lock_guard<std::mutex> l(w.mutex);
+      w.woken = true;
+      w.cond.notify_one();
+   }
+}  // end of 'fiber_internals'
+
+
+namespace this_fiber
+{
+      // true - the caller is a fiber
+   inline bool inside() noexcept { return nullptr!=fbis::current().running; }
+      // the fiber is posted to the back of the pool, std::this_thread::yield out of a fiber
+   inline void yield()
+   {
+      if(fbis::fiber* f = fbis::current().running)
+         fbis::suspend([](void* p) { fbis::wake(static_cast<fbis::fiber*>(p)); }, f);
+      else
+         std::this_thread::yield();
+   }
+}  // end of 'this_fiber'
+
+
+class fiber_executor
+{
+public:
+   static constexpr size_t default_stack_size = 64*1024;
+
+   explicit fiber_executor(thread_pool& pool, size_t stack_size = default_stack_size);
+      // waits for all the fibers, a fiber blocked forever blocks it as well
+   ~fiber_executor();
+   fiber_executor(const fiber_executor&)              = delete;
+   fiber_executor& operator=(const fiber_executor&)   = delete;
+
+   /**
+      \brief f(args...) is run by a new fiber on the workers of the pool
+      \retval std::future<retval of Function>, f's exception is stored in it. Waiting for it blocks the caller, a fiber as well
+      \throw std::system_error - no memory for a stack
+   */
+   template <typename Function, typename... Args>
+   decltype(auto) spawn(Function&&, Args&&...);
+
+      // the fibers spawned and not finished yet, either running, queued or suspended
+   size_t   active() const;
+   size_t   stack_size() const noexcept { return stack_size_; }
+
+private:
+   friend void fbis::resume(fbis::fiber*) noexcept;
+
+   fbis::fiber*   acquire();
+   void           retire(fbis::fiber*) noexcept;
+
+private:
+   thread_pool&                              pool_;
+   const size_t                              stack_size_;
+   mutable std::mutex                        mutex_;
+   std::condition_variable                   idle_;
+   size_t                                    active_ {0};   // guarded by mutex_
+   std::vector<std::unique_ptr<fbis::fiber>> free_;         // finished fibers with their stacks, guarded by mutex_
+};
+
+
+/**
+   \brief a mutex suspending the fiber (blocking the thread) which waits for it, the ownership is handed over to the first waiter
+*/
+class fiber_mutex
+{
+public:
+   fiber_mutex() = default;
+   fiber_mutex(const fiber_mutex&)              = delete;
+   fiber_mutex& operator=(const fiber_mutex&)   = delete;
+
+   void     lock();
+   bool     try_lock();
+   void     unlock();
+
+private:
+   std::mutex           guard_;
+   bool                 locked_ {false};  // guarded by guard_
+   fbis::waiter_list    waiters_;         // guarded by guard_
+};
+
+/**
+   \brief std::condition_variable_any of fiber_mutex: the fiber is suspended, a thread is blocked. No timed waits
+*/
+class fiber_condition_variable
+{
+public:
+   fiber_condition_variable() = default;
+   fiber_condition_variable(const fiber_condition_variable&)              = delete;
+   fiber_condition_variable& operator=(const fiber_condition_variable&)   = delete;
+
+   void     notify_one();
+   void     notify_all();
+   template <typename Lock>
+   void     wait(Lock&);
+   template <typename Lock, typename Predicate>
+   void     wait(Lock&, Predicate);
+
+private:
+   std::mutex           guard_;
+   fbis::waiter_list    waiters_;   // guarded by guard_
+};
+
+template <>
+struct condition_of<fiber_mutex>
+{
+   using type = fiber_condition_variable;
+};
+
+   // wait_pop suspends a fiber, push may be called by a thread or a fiber
+template <typename VALUE_T>
+using fiber_queue = threadsafe_queue<VALUE_T, fiber_mutex>;
+
+
+/**
+      fiber_internals implementation
+*/
+inline
+void fbis::resume(fiber* f) noexcept
+{
+   current_type& c = current();    // the worker is not switched to another thread
+   const current_type outer = c;
+   ucontext_t here;
+   c = current_type{f, &here, nullptr, nullptr};
+   swapcontext(&here, &f->context);
+
+   const current_type back = c;
+   c = outer;
+   if(f->done)
+      f->owner->retire(f);
+   else if(back.after)
+      back.after(back.after_arg);   // 'f' may be resumed by another worker from now on
+}
+
+
+/**
+      fiber_executor implementation
+*/
+inline
+fiber_executor::fiber_executor(thread_pool& pool, size_t stack_size)
+   : pool_(pool), stack_size_(stack_size)
+{
+}
+
+inline
+fiber_executor::~fiber_executor()
+{
+   blocking_section blocking;
+   std::unique_lock<std::mutex> l(mutex_);
+   idle_.wait(l, [this] { return 0==active_; });
+}
+
+inline
+size_t fiber_executor::active() const
+{
+   std::lock_guard<std::mutex> l(mutex_);
+   return active_;
+}
+
+inline
+fbis::fiber* fiber_executor::acquire()
+{
+   std::unique_ptr<fbis::fiber> f;
+   {  std::lock_guard<std::mutex> l(mutex_);
+      if(!free_.empty())
+      {
+         f = std::move(free_.back());
+         free_.pop_back();
+      }
+   }
+   if(!f)
+   {
+      const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+      const size_t size = (stack_size_ + page - 1) / page * page + page;
+      f.reset(new fbis::fiber);     // the owner of the mapping first, it is unmapped if anything below throws
+      void* memory = mmap(nullptr, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+      if(MAP_FAILED==memory)
+         throw std::system_error(errno, std::system_category(), "fiber_executor: a stack");
+      f->memory      = memory;
+      f->memory_size = size;
+      f->guard_size  = page;
+      if(0!=mprotect(memory, page, PROT_NONE))  // the stack grows down to the guard page
+         throw std::system_error(errno, std::system_category(), "fiber_executor: a guard page");
+      f->pool  = &pool_;
+      f->owner = this;
+   }
+   fbis::prepare(f.get());
+
+   std::lock_guard<std::mutex> l(mutex_);
+   ++active_;
+   return f.release();
+}
+
+inline
+void fiber_executor::retire(fbis::fiber* f) noexcept
+{
+      // notified under the lock: the executor may be gone right after the lock is released
+   std::lock_guard<std::mutex> l(mutex_);
+   free_.emplace_back(f);
+   if(0==--active_)
+      idle_.notify_all();
+}
+
+template <typename Function, typename... Args>
+inline
+decltype(auto) fiber_executor::spawn(Function&& f, Args&&... args)
+{
+   using result_type = std::result_of_t<std::decay_t<Function>(std::decay_t<Args>...)>;
+
+      // std::ref(f)(...) is INVOKE (pointers to members are supported)
+   std::packaged_task<result_type()> pack {
+      [f=std::decay_t<Function>{std::forward<Function>(f)},a=std::make_tuple(std::forward<Args>(args)...)]() mutable -> result_type {
+         return thread_ex::apply(std::ref(f), std::move(a));
+      }
+   };
+   auto future = pack.get_future();
+   fbis::fiber* fiber = acquire();
+   fiber->work.reset(new fbis::job_impl<decltype(pack)>(std::move(pack)));
+   fbis::wake(fiber);
+   return future;
+}
+
+
+/**
+      fiber_mutex implementation
+*/
+inline
+void fiber_mutex::lock()
+{
+   std::unique_lock<std::mutex> g(guard_);
+   if(!locked_)
+   {
+      locked_ = true;
+      return;
+   }
+   fbis::waiter w;
+   waiters_.push(&w);
+   fbis::park(w, g);    // woken up by 'unlock' as the owner
+}
+
+inline
+bool fiber_mutex::try_lock()
+{
+   std::lock_guard<std::mutex> g(guard_);
+   if(locked_)
+      return false;
+   locked_ = true;
+   return true;
+}
+
+inline
+void fiber_mutex::unlock()
+{
+   fbis::waiter* w {nullptr};
+   {  std::lock_guard<std::mutex> g(guard_);
+      assert(locked_);
+      w = waiters_.pop();
+      if(!w)
+         locked_ = false;
+   }
+   if(w)
+      fbis::wake(*w);   // still locked, the ownership goes to the waiter
+}
+
+
+/**
+      fiber_condition_variable implementation
+*/
+inline
+void fiber_condition_variable::notify_one()
+{
+   fbis::waiter* w {nullptr};
+   {  std::lock_guard<std::mutex> g(guard_);
+      w = waiters_.pop();
+   }
+   if(w)
+      fbis::wake(*w);
+}
+
+inline
+void fiber_condition_variable::notify_all()
+{
+   fbis::waiter* w {nullptr};
+   {  std::lock_guard<std::mutex> g(guard_);
+      w = waiters_.take_all();
+   }
+   while(w)
+   {
+      fbis::waiter* next = w->next;    // 'w' may be gone once it is woken up
+      fbis::wake(*w);
+      w = next;
+   }
+}
+
+template <typename Lock>
+inline
+void fiber_condition_variable::wait(Lock& lock)
+{
+   fbis::waiter w;
+   std::unique_lock<std::mutex> g(guard_);
+   waiters_.push(&w);
+   lock.unlock();    // queued already, a notification after the unlock is not lost
+   fbis::park(w, g);
+   lock.lock();
+}
+
+template <typename Lock, typename Predicate>
+inline
+void fiber_condition_variable::wait(Lock& lock, Predicate p)
+{
+   while(!p())
+      wait(lock);
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_FIBER_INCLUDED_
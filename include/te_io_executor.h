@@ -0,0 +1,506 @@
+#ifndef _THREAD_EX_IO_EXECUTOR_INCLUDED_
+#define _THREAD_EX_IO_EXECUTOR_INCLUDED_
+
+/**
+	\file 	te_io_executor.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#if defined(_WIN32)
+   #error "te_io_executor.h: POSIX only (pread/pwrite, io_uring on Linux)"
+#endif
+
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <system_error>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <cassert>
+#include <unistd.h>
+#include <sys/uio.h>
+#if defined(__linux__) && defined(__has_include)
+   #if __has_include(<linux/io_uring.h>)
+      #include <linux/io_uring.h>
+      #ifdef IORING_FEAT_EXT_ARG    // the waits of the reaper are bounded (Linux 5.11+)
+         #define _THREAD_EX_IO_URING_
+         #include <sys/mman.h>
+         #include <sys/syscall.h>
+      #endif
+   #endif
+#endif
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_container.h"
+#include "te_thread_pool.h"
+#include "te_thread_unjoinable.h"
+
+/**
+   \brief asynchronous reads & writes of files, many requests in flight, completed into futures or continuations on a thread_pool
+
+   A blocking read() in a thread_pool task holds the worker for the whole I/O and the queue depth is the number of workers.
+   - io_uring (Linux 5.11+, raw syscalls, no liburing): a request is a submission queue entry, a completion thread reaps them all
+   - a blocking-I/O thread group (pread/pwrite) if io_uring is not there (an old kernel, disabled by sysctl, other POSIX)
+   - up to 'depth' requests are in flight, a request beyond it waits for a free slot
+   - read(...) & write(...) return std::future<size_t>, a failure is std::system_error in it
+   - if the ring fails for good (io_uring_enter of the reaper), the requests in flight fail with its error and the next ones throw it
+   - read(..., f) & write(..., f) post f(size_t, std::error_code) to the pool
+   The result is the number of bytes transferred at 'offset', a short read is not an error (see pread).
+   The buffer must live until the request is completed. The destructor waits for the requests in flight.
+
+   \remark "Efficient IO with io_uring", J. Axboe, https://kernel.dk/io_uring.pdf
+   \remark https://man7.org/linux/man-pages/man2/io_uring_setup.2.html
+   \example unit/test_io_executor.cpp
+*/
+
+namespace thread_ex
+{
+
+namespace iois // io_executor_internals
+{
+   struct request
+   {
+      int            fd;
+      bool           write;
+      struct iovec   io;
+      std::uint64_t  offset;
+      request*       prev {nullptr};   // the requests in the ring, guarded by the mutex of io_executor
+      request*       next {nullptr};
+
+      request(int f, bool w, void* buffer, size_t size, std::uint64_t o) noexcept
+         : fd(f), write(w), io{buffer, size}, offset(o) {}
+      virtual ~request() {}
+      virtual void complete(size_t, std::error_code) noexcept = 0;
+   };
+
+   template <typename Completion>
+   struct request_impl : request
+   {
+      template <typename... Args>
+      request_impl(Completion&& c, Args&&... args) : request(std::forward<Args>(args)...), completion_(std::move(c)) {}
+      void complete(size_t n, std::error_code ec) noexcept override { completion_(n, ec); }
+      Completion completion_;
+   };
+
+      // the blocking way, EINTR is retried
+   inline std::error_code perform(request& r, size_t& n) noexcept
+   {
+      for(;;)
+      {
+         const ssize_t done = r.write? pwrite(r.fd, r.io.iov_base, r.io.iov_len, static_cast<off_t>(r.offset))
+                                     : pread(r.fd, r.io.iov_base, r.io.iov_len, static_cast<off_t>(r.offset));
+         if(done >= 0)
+         {
+            n = static_cast<size_t>(done);
+            return {};
+         }
+         if(EINTR!=errno)
+            return std::error_code(errno, std::system_category());
+      }
+   }
+
+#ifdef _THREAD_EX_IO_URING_
+      // the longest wait of the reaper for a completion, then it checks whether it is stopped
+   constexpr long reap_wait_ns = 100*1000*1000;
+
+   class ring
+   {
+   public:
+      ring() = default;
+      ring(const ring&)              = delete;
+      ring& operator=(const ring&)   = delete;
+      ~ring();
+
+      bool     open(unsigned entries) noexcept;    // false - there is no io_uring, the ring is not usable
+      unsigned entries() const noexcept { return sq_entries_; }
+         // one entry, the caller serializes the submissions. user_data 0 is the stop of 'reap'
+      int      submit(std::uint8_t opcode, request*) noexcept;
+         // the completions of the ring, by one thread, until 'stop' or an error of io_uring_enter other than EINTR.
+         // the error is returned, the requests in flight are not completed by the ring then
+      template <typename Completion>
+      std::error_code reap(Completion&&);
+         // 'reap' returns at once by a NOP entry, or within 'reap_wait_ns' if the NOP can't be submitted
+      void     stop() noexcept;
+
+   private:
+      int                  fd_ {-1};
+      void*                sq_ptr_ {nullptr};
+      size_t               sq_size_ {0};
+      void*                cq_ptr_ {nullptr};
+      size_t               cq_size_ {0};
+      io_uring_sqe*        sqes_ {nullptr};
+      size_t               sqes_size_ {0};
+      unsigned             sq_entries_ {0};
+      unsigned*            sq_tail_ {nullptr};
+      unsigned*            sq_mask_ {nullptr};
+      unsigned*            sq_array_ {nullptr};
+      unsigned*            cq_head_ {nullptr};
+      unsigned*            cq_tail_ {nullptr};
+      unsigned*            cq_mask_ {nullptr};
+      io_uring_cqe*        cqes_ {nullptr};
+      std::atomic_bool     stopping_ {false};
+   };
+
+   inline ring::~ring()
+   {
+      if(sqes_)
+         munmap(sqes_, sqes_size_);
+      if(cq_ptr_ && cq_ptr_!=sq_ptr_)
+         munmap(cq_ptr_, cq_size_);
+      if(sq_ptr_)
+         munmap(sq_ptr_, sq_size_);
+      if(fd_ >= 0)
+         close(fd_);
+   }
+
+   inline bool ring::open(unsigned entries) noexcept
+   {
+      io_uring_params p;
+      std::memset(&p, 0, sizeof(p));
+      fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+      if(fd_ < 0)
+         return false;
+
+      sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+      cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+      if(0==(p.features & IORING_FEAT_EXT_ARG))
+         return false;     // a wait of the reaper can't be bounded, it might be never stopped
+      const bool single = 0!=(p.features & IORING_FEAT_SINGLE_MMAP);
+      if(single)
+         sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+      sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+      if(MAP_FAILED==sq_ptr_)
+         return sq_ptr_ = nullptr, false;
+      cq_ptr_ = single? sq_ptr_ : mmap(nullptr, cq_size_, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+      if(MAP_FAILED==cq_ptr_)
+         return cq_ptr_ = nullptr, false;
+      sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+      void* sqes = mmap(nullptr, sqes_size_, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, fd_, IORING_OFF_SQES);
+      if(MAP_FAILED==sqes)
+         return false;
+      sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+      char* sq = static_cast<char*>(sq_ptr_);
+      char* cq = static_cast<char*>(cq_ptr_);
+      sq_entries_ = p.sq_entries;
+      sq_tail_    = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+      sq_mask_    = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+      sq_array_   = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+      cq_head_    = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+      cq_tail_    = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+      cq_mask_    = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+      cqes_       = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+      return true;
+   }
+
+   inline int ring::submit(std::uint8_t opcode, request* r) noexcept
+   {
+         // the kernel consumes the entries it is told about by io_uring_enter, a slot is free by then
+      const unsigned tail  = *sq_tail_;
+      const unsigned index = tail & *sq_mask_;
+      io_uring_sqe& e = sqes_[index];
+      std::memset(&e, 0, sizeof(e));
+      e.opcode    = opcode;
+      e.user_data = reinterpret_cast<std::uintptr_t>(r);
+      if(r)
+      {
+         e.fd     = r->fd;
+         e.addr   = reinterpret_cast<std::uintptr_t>(&r->io);
+         e.len    = 1;
+         e.off    = r->offset;
+      }
+      sq_array_[index] = index;
+      __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+      for(;;)
+      {
+         const long submitted = syscall(__NR_io_uring_enter, fd_, 1, 0, 0, nullptr, 0);
+         if(submitted >= 0)
+            return 0;
+         if(EINTR!=errno && EAGAIN!=errno && EBUSY!=errno)
+         {
+            const int error = errno;
+            __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);  // not consumed, taken back
+            return error;
+         }
+      }
+   }
+
+   template <typename Completion>
+   inline std::error_code ring::reap(Completion&& c)
+   {
+      for(;;)
+      {
+         unsigned head = *cq_head_;
+         const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+         if(head==tail)
+         {
+            if(stopping_.load(std::memory_order_acquire))
+               return {};
+            __kernel_timespec period {0, reap_wait_ns};
+            io_uring_getevents_arg arg;
+            std::memset(&arg, 0, sizeof(arg));
+            arg.ts = reinterpret_cast<std::uintptr_t>(&period);
+            if(syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS|IORING_ENTER_EXT_ARG, &arg, sizeof(arg)) < 0
+               && EINTR!=errno && ETIME!=errno)
+               return std::error_code(errno, std::system_category());   // e.g. EBADF, the ring is not usable
+            continue;
+         }
+         bool stop {false};
+         for(; head!=tail; ++head)
+         {
+            const io_uring_cqe& e = cqes_[head & *cq_mask_];
+            if(0==e.user_data)
+               stop = true;
+            else
+               c(reinterpret_cast<request*>(static_cast<std::uintptr_t>(e.user_data)), e.res);
+         }
+         __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+         if(stop)
+            return {};
+      }
+   }
+
+   inline void ring::stop() noexcept
+   {
+      if(0==submit(IORING_OP_NOP, nullptr))
+         return;     // user_data 0 is seen by the reaper
+      stopping_.store(true, std::memory_order_release);
+   }
+#endif // _THREAD_EX_IO_URING_
+}  // end of 'io_executor_internals'
+
+
+class io_executor
+{
+public:
+   enum class backend { io_uring, threads };
+
+   static constexpr size_t default_depth     = 256;
+   static constexpr size_t fallback_threads  = 4;
+
+      // 'depth' - the requests in flight, 'preferred' - backend::threads is a blocking-I/O thread group whatever the kernel is
+   explicit io_executor(thread_pool& pool, size_t depth = default_depth, backend preferred = backend::io_uring);
+   ~io_executor();
+   io_executor(const io_executor&)              = delete;
+   io_executor& operator=(const io_executor&)   = delete;
+
+      // up to 'size' bytes of 'fd' at 'offset', std::future<size_t>
+   std::future<size_t>  read(int fd, void* buffer, size_t size, std::uint64_t offset);
+   std::future<size_t>  write(int fd, const void* buffer, size_t size, std::uint64_t offset);
+      // f(size_t, std::error_code) is posted to the pool when the request is completed, 'f' must not throw
+   template <typename Function>
+   void     read(int fd, void* buffer, size_t size, std::uint64_t offset, Function&& f);
+   template <typename Function>
+   void     write(int fd, const void* buffer, size_t size, std::uint64_t offset, Function&& f);
+
+   backend  kind() const noexcept   { return kind_; }
+   size_t   depth() const noexcept  { return depth_; }
+   size_t   in_flight() const;
+
+private:
+   template <typename Completion>
+   void     submit(Completion&&, int fd, bool write, void* buffer, size_t size, std::uint64_t offset);
+   std::future<size_t> submit_future(int fd, bool write, void* buffer, size_t size, std::uint64_t offset);
+   void     complete(iois::request*, size_t, std::error_code) noexcept;
+#ifdef _THREAD_EX_IO_URING_
+   void     fail_pending(std::error_code) noexcept;
+#endif
+
+private:
+   thread_pool&                        pool_;
+   backend                             kind_ {backend::threads};
+   size_t                              depth_;
+   mutable std::mutex                  mutex_;        // serializes the submissions as well
+   std::condition_variable             slot_;
+   size_t                              in_flight_ {0};   // guarded by mutex_
+#ifdef _THREAD_EX_IO_URING_
+   iois::ring                          ring_;
+   iois::request*                      pending_ {nullptr};  // the requests in the ring, guarded by mutex_
+   std::error_code                     broken_;       // guarded by mutex_, the error of io_uring_enter which has stopped the reaper
+   std::unique_ptr<joined_thread>      reaper_;
+#endif
+   threadsafe_queue<iois::request*>    queue_;        // the thread group
+   std::vector<stoppable_thread>       threads_;      // the last one: stopped & joined first
+};
+
+inline
+io_executor::io_executor(thread_pool& pool, size_t depth, backend preferred)
+   : pool_(pool), depth_(depth?depth:1)
+{
+#ifdef _THREAD_EX_IO_URING_
+   if(backend::io_uring==preferred && ring_.open(static_cast<unsigned>(depth_)))
+   {
+      kind_  = backend::io_uring;
+      depth_ = std::min<size_t>(depth_, ring_.entries());
+      reaper_.reset(new joined_thread{std::thread{[this] {
+         const std::error_code ec = ring_.reap([this](iois::request* r, int res) {
+            {  std::lock_guard<std::mutex> l(mutex_);    // 'r' was published under the lock, the ring is not seen by TSan
+               (r->prev? r->prev->next : pending_) = r->next;
+               if(r->next)
+                  r->next->prev = r->prev;
+            }
+            if(res < 0)
+               complete(r, 0, std::error_code(-res, std::system_category()));
+            else
+               complete(r, static_cast<size_t>(res), {});
+         });
+         if(ec)
+            fail_pending(ec);
+      }}});
+      return;
+   }
+#else
+   (void)preferred;
+#endif
+   for(size_t i = 0; i < std::min(depth_, size_t{fallback_threads}); ++i)
+      threads_.emplace_back([this](stop_token token) {
+         iois::request* r {nullptr};
+         while(queue_.wait_pop(r, token))
+         {
+            size_t n {0};
+            const std::error_code ec = iois::perform(*r, n);
+            complete(r, n, ec);
+         }
+      });
+}
+
+inline
+io_executor::~io_executor()
+{
+   {  blocking_section blocking;
+      std::unique_lock<std::mutex> l(mutex_);
+      slot_.wait(l, [this] { return 0==in_flight_; });
+#ifdef _THREAD_EX_IO_URING_
+      if(reaper_ && !broken_)
+         ring_.stop();
+#endif
+   }
+#ifdef _THREAD_EX_IO_URING_
+   reaper_.reset();
+#endif
+}
+
+inline
+size_t io_executor::in_flight() const
+{
+   std::lock_guard<std::mutex> l(mutex_);
+   return in_flight_;
+}
+
+inline
+void io_executor::complete(iois::request* r, size_t n, std::error_code ec) noexcept
+{
+   std::unique_ptr<iois::request> owned {r};
+   owned->complete(n, ec);
+   owned.reset();
+      // notified under the lock: the destructor may go on right after the lock is released
+   std::lock_guard<std::mutex> l(mutex_);
+   --in_flight_;
+   slot_.notify_all();
+}
+
+#ifdef _THREAD_EX_IO_URING_
+   // by the reaper which has left on an error, the completions of the requests in flight will never come
+inline
+void io_executor::fail_pending(std::error_code ec) noexcept
+{
+   iois::request* r {nullptr};
+   {  std::lock_guard<std::mutex> l(mutex_);
+      broken_ = ec;
+      std::swap(r, pending_);
+   }
+   while(r)
+   {
+      iois::request* next = r->next;
+      complete(r, 0, ec);
+      r = next;
+   }
+}
+#endif
+
+template <typename Completion>
+inline
+void io_executor::submit(Completion&& c, int fd, bool write, void* buffer, size_t size, std::uint64_t offset)
+{
+   std::unique_ptr<iois::request> r {new iois::request_impl<std::decay_t<Completion>>(std::forward<Completion>(c), fd, write, buffer, size, offset)};
+   {  blocking_section blocking;
+      std::unique_lock<std::mutex> l(mutex_);
+      slot_.wait(l, [this] { return in_flight_ < depth_; });
+#ifdef _THREAD_EX_IO_URING_
+      if(backend::io_uring==kind_)
+      {
+         if(broken_)
+            throw std::system_error(broken_, "io_executor: the ring is broken");
+         if(const int error = ring_.submit(write? IORING_OP_WRITEV : IORING_OP_READV, r.get()))
+            throw std::system_error(error, std::system_category(), "io_executor: io_uring_enter");
+         ++in_flight_;
+         r->next = pending_;
+         if(pending_)
+            pending_->prev = r.get();
+         pending_ = r.release();   // owned by the ring
+         return;
+      }
+#endif
+      ++in_flight_;
+   }
+   queue_.push(r.release());
+}
+
+inline
+std::future<size_t> io_executor::submit_future(int fd, bool write, void* buffer, size_t size, std::uint64_t offset)
+{
+   auto promise = std::make_shared<std::promise<size_t>>();
+   auto future = promise->get_future();
+   submit([promise](size_t n, std::error_code ec) {
+      if(ec)
+         promise->set_exception(std::make_exception_ptr(std::system_error(ec, "io_executor")));
+      else
+         promise->set_value(n);
+   }, fd, write, buffer, size, offset);
+   return future;
+}
+
+inline
+std::future<size_t> io_executor::read(int fd, void* buffer, size_t size, std::uint64_t offset)
+{
+   return submit_future(fd, false, buffer, size, offset);
+}
+
+inline
+std::future<size_t> io_executor::write(int fd, const void* buffer, size_t size, std::uint64_t offset)
+{
+   return submit_future(fd, true, const_cast<void*>(buffer), size, offset);
+}
+
+template <typename Function>
+inline
+void io_executor::read(int fd, void* buffer, size_t size, std::uint64_t offset, Function&& f)
+{
+   submit([this,f=std::decay_t<Function>{std::forward<Function>(f)}](size_t n, std::error_code ec) mutable {
+      pool_.post([f=std::move(f),n,ec]() mutable { f(n, ec); });
+   }, fd, false, buffer, size, offset);
+}
+
+template <typename Function>
+inline
+void io_executor::write(int fd, const void* buffer, size_t size, std::uint64_t offset, Function&& f)
+{
+   submit([this,f=std::decay_t<Function>{std::forward<Function>(f)}](size_t n, std::error_code ec) mutable {
+      pool_.post([f=std::move(f),n,ec]() mutable { f(n, ec); });
+   }, fd, true, const_cast<void*>(buffer), size, offset);
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_IO_EXECUTOR_INCLUDED_
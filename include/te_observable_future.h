@@ -0,0 +1,186 @@
+#ifndef _THREAD_EX_OBSERVABLE_FUTURE_INCLUDED_
+#define _THREAD_EX_OBSERVABLE_FUTURE_INCLUDED_
+
+/**
+	\file 	te_observable_future.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <memory>
+#include <future>
+#include <functional>
+#include <utility>
+#include <type_traits>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+
+/**
+   \brief std::future which tells when it is ready
+
+   std::future can only be waited for, a thread which has several of them either blocks on each one in turn or polls them.
+   observable_future<T> is std::future<T> (it is converted to the one by move) plus a completion cell shared with the producer:
+   - the producer completes the cell right after it has made the future ready
+   - 'on_ready' registers a callback which is run once by the thread completing the cell, or at once if it is completed already
+   - the list of callbacks is lock-free, a producer completing a cell nobody observes pays for a single atomic exchange
+
+   thread_pool::submit and call_async(pooled, ...) return observable futures, when_all and when_any (see te_when.h) are built on them.
+
+   \remark "Concurrency TS" (ISO/IEC TS 19571:2016), std::experimental::future::then
+   \example unit/test_when.cpp
+*/
+
+namespace thread_ex
+{
+
+namespace ofis // observable_future_internals
+{
+   class completion_cell
+   {
+      struct node
+      {
+         std::function<void()>   f;
+         node*                   next;
+      };
+
+   public:
+      completion_cell() noexcept = default;
+      completion_cell(const completion_cell&)              = delete;
+      completion_cell& operator=(const completion_cell&)   = delete;
+      ~completion_cell();
+
+         // runs the registered callbacks in order of registration, the ones registered later are run at once
+      void     complete();
+      bool     completed() const noexcept   { return head_.load(std::memory_order_acquire)==mark(); }
+      template <typename Function>
+      void     on_complete(Function&&);
+
+   private:
+         // the head of a completed cell, it is never an address of a node
+      node*    mark() const noexcept   { return reinterpret_cast<node*>(const_cast<completion_cell*>(this)); }
+
+   private:
+      std::atomic<node*>   head_ {nullptr};
+   };
+
+   inline
+   completion_cell::~completion_cell()
+   {
+      node* n = head_.load(std::memory_order_relaxed);
+      while(n && n!=mark())
+      {
+         node* next = n->next;
+         delete n;
+         n = next;
+      }
+   }
+
+   inline
+   void completion_cell::complete()
+   {
+      node* n = head_.exchange(mark(), std::memory_order_acq_rel);
+      if(n==mark())
+         return;
+      node* ordered {nullptr};   // the list is LIFO
+      while(n)
+      {
+         node* next = n->next;
+         n->next = ordered;
+         ordered = n;
+         n = next;
+      }
+      while(ordered)
+      {
+         std::unique_ptr<node> current {ordered};
+         ordered = ordered->next;
+         current->f();
+      }
+   }
+
+   template <typename Function>
+   inline
+   void completion_cell::on_complete(Function&& f)
+   {
+      std::unique_ptr<node> n {new node{std::forward<Function>(f), head_.load(std::memory_order_acquire)}};
+      while(n->next!=mark())
+      {
+         if(head_.compare_exchange_weak(n->next, n.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+         {
+            n.release();
+            return;
+         }
+      }
+      n->f();
+   }
+
+      // a producer: calls 'f' and then completes the cell.
+      // the cell is completed also if 'f' is destroyed without a call, e.g. a task dropped by thread_pool::terminate (its future gets broken_promise)
+   template <typename Function>
+   struct notifying
+   {
+         // completes the cell when it is destroyed, i.e. after 'f' (the members are destroyed in reverse order)
+         // so a dropped packaged_task has stored broken_promise before the callbacks are run
+      struct completer
+      {
+         std::shared_ptr<completion_cell> cell;
+
+         explicit completer(std::shared_ptr<completion_cell> c) noexcept : cell(std::move(c)) {}
+         completer(completer&&) noexcept              = default;
+         completer& operator=(completer&&) noexcept   = default;
+         ~completer()                                 { if(cell) cell->complete(); }
+      };
+
+      completer   done;
+      Function    f;
+
+      notifying(std::shared_ptr<completion_cell> c, Function&& g) : done(std::move(c)), f(std::move(g)) {}
+
+      template <typename... Args>
+      void operator()(Args&&... args)
+      {
+         f(std::forward<Args>(args)...);
+         auto c = std::move(done.cell);
+         c->complete();
+      }
+   };
+}  // end of 'observable_future_internals'
+
+template <typename T>
+class observable_future : public std::future<T>
+{
+public:
+   observable_future() noexcept = default;
+      // the producer completes 'cell' once 'f' is ready
+   observable_future(std::future<T>&& f, std::shared_ptr<ofis::completion_cell> cell) noexcept
+      : std::future<T>(std::move(f)), cell_(std::move(cell)) {}
+   observable_future(observable_future&&) noexcept             = default;
+   observable_future& operator=(observable_future&&) noexcept  = default;
+
+      // f() is called once the future is ready, by the thread which has made it ready or by the caller if the future is ready already.
+      // the callback must be short and must not throw, it runs on a worker thread of the producer.
+      // std::future_error (no_state) - the future has no shared state
+   template <typename Function>
+   void  on_ready(Function&&);
+
+private:
+   std::shared_ptr<ofis::completion_cell> cell_;
+};
+
+template <typename T>
+template <typename Function>
+inline
+void observable_future<T>::on_ready(Function&& f)
+{
+   if(!cell_ || !this->valid())
+      throw std::future_error(std::future_errc::no_state);
+   cell_->on_complete(std::forward<Function>(f));
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_OBSERVABLE_FUTURE_INCLUDED_
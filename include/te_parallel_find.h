@@ -0,0 +1,219 @@
+#ifndef _THREAD_EX_PARALLEL_FIND_INCLUDED_
+#define _THREAD_EX_PARALLEL_FIND_INCLUDED_
+
+/**
+	\file 	te_parallel_find.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <exception>
+#include <algorithm>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_thread_pool.h"
+#include "te_runtime_concurrency.h"
+#include "te_sequence.h"
+
+/**
+   \brief std::find_if and std::any_of of random-access ranges on a thread_pool, the search stops as soon as the result is known
+
+   The range is split into blocks, the calling thread and the helpers posted to the pool take them in ascending order
+   (an atomic counter) until there are none left. The least index of a match is a shared atomic:
+   - a block is searched by short strides, the one at or after the least match found so far is not searched
+   - a block which finds a match stops at once, as do the blocks after it
+   So the result is the first match of the range, as std::find_if returns, and the elements after it are mostly not visited.
+   The calling thread does not wait for the helpers which have not started: it searches their blocks itself, a pool busy
+   with other tasks (or a caller holding a lock the workers wait for) only makes the search sequential, never stalls it.
+   'pred' is called concurrently, an exception thrown by it stops the search and it is rethrown to the caller.
+   'blocks' - the number of blocks and threads, 0 (by default) means runtime_concurrency (4 blocks per thread).
+   find_first(sequence, pool, pred) is sequence_wrap::find_first(pred) on the pool: threadsafe_vector is searched by parallel_find_if, a list by std::find_if.
+
+   \remark "C++ Concurrency in Action", A. Williams, chapter 8.5.2 (a parallel implementation of std::find)
+   \example unit/test_parallel_find.cpp
+*/
+
+namespace thread_ex
+{
+
+   // the elements per thread below which a helper does not pay for its task
+constexpr size_t find_min_block = 4*1024;
+
+namespace pfis // parallel_find_internals
+{
+#ifdef _MSC_VER
+   #pragma warning( push )
+   #pragma warning( disable: 4571 ) // Informational: catch(...) semantics changed since Visual C++ 7.1; structured exceptions (SEH) are no longer caught
+#endif
+      // shared by the caller and the helpers, a helper which starts late finds no blocks and does not touch the range
+   template <typename RandomIt, typename UnaryPredicate>
+   class search
+   {
+   public:
+      search(RandomIt first, size_t size, size_t blocks, UnaryPredicate pred)
+         : first_(first), size_(size), block_((size + blocks - 1) / blocks), blocks_(blocks), pred_(std::move(pred)), best_(size) {}
+
+         // searches the blocks until there are none left
+      void run() noexcept
+      {
+         for(size_t b; (b = next_.fetch_add(1, std::memory_order_relaxed)) < blocks_; )
+         {
+            search_block(b);
+            std::lock_guard<std::mutex> hold {guard_};
+            if(blocks_==++done_)
+               all_done_.notify_all();
+         }
+      }
+
+         // the least index of a match, 'size' - there is none
+      size_t wait()
+      {
+         std::unique_lock<std::mutex> hold {guard_};
+         all_done_.wait(hold, [this] { return blocks_==done_; }); // only for the blocks being searched, they stop soon
+         if(error_)
+            std::rethrow_exception(error_);
+         return best_.load(std::memory_order_relaxed);
+      }
+
+   private:
+      static constexpr size_t stride = 256;  // the elements between the checks of 'best_'
+
+      void search_block(size_t b) noexcept
+      {
+         const size_t end = std::min(size_, (b+1) * block_);
+         try
+         {
+            for(size_t i = b * block_; i < end; i += stride)
+            {
+               if(best_.load(std::memory_order_relaxed) <= i)
+                  return;     // a match before this stride is found
+               const auto last = first_ + static_cast<std::ptrdiff_t>(std::min(end, i + stride));
+               const auto it = std::find_if(first_ + static_cast<std::ptrdiff_t>(i), last, std::ref(pred_));
+               if(it!=last)
+               {
+                  found(static_cast<size_t>(it - first_));
+                  return;
+               }
+            }
+         }
+         catch(...)
+         {
+            {  std::lock_guard<std::mutex> hold {guard_};
+               if(!error_)
+                  error_ = std::current_exception();
+            }
+            best_.store(0, std::memory_order_relaxed);   // stops the others
+         }
+      }
+
+      void found(size_t i) noexcept
+      {
+         size_t best = best_.load(std::memory_order_relaxed);
+         while(i < best && !best_.compare_exchange_weak(best, i, std::memory_order_relaxed))
+            ;
+      }
+
+      const RandomIt          first_;
+      const size_t            size_;
+      const size_t            block_;     // elements per block
+      const size_t            blocks_;
+      UnaryPredicate          pred_;
+      std::atomic<size_t>     next_    {0};
+      std::atomic<size_t>     best_;
+      std::mutex              guard_;
+      std::condition_variable all_done_;
+      size_t                  done_    {0};  // the blocks searched, under 'guard_'
+      std::exception_ptr      error_;        // under 'guard_'
+   };
+#ifdef _MSC_VER
+   #pragma warning( pop )
+#endif
+}  // end of 'parallel_find_internals'
+
+   // std::find_if: the first element of [first,last) satisfying 'pred', 'last' if there is none
+template <typename RandomIt, typename UnaryPredicate>
+inline
+RandomIt parallel_find_if(thread_pool& pool, RandomIt first, RandomIt last, UnaryPredicate pred, size_t blocks = 0)
+{
+   const size_t n = static_cast<size_t>(std::distance(first, last));
+   const size_t threads = std::min(n, blocks? blocks : runtime_concurrency(n?n:1, find_min_block));
+   if(threads < 2)
+      return std::find_if(first, last, std::move(pred));
+   if(0==blocks)
+      blocks = std::min(n, 4*threads);
+
+   auto s = std::make_shared<pfis::search<RandomIt, UnaryPredicate>>(first, n, blocks, std::move(pred));
+   for(size_t t = 1; t < threads; ++t)
+      pool.post([s] { s->run(); });
+   s->run();
+   return first + static_cast<std::ptrdiff_t>(s->wait());
+}
+
+   // std::any_of: whether an element of [first,last) satisfies 'pred'
+template <typename RandomIt, typename UnaryPredicate>
+inline
+bool parallel_any_of(thread_pool& pool, RandomIt first, RandomIt last, UnaryPredicate pred, size_t blocks = 0)
+{
+   return last!=parallel_find_if(pool, first, last, std::move(pred), blocks);
+}
+
+   // the same on default_thread_pool()
+template <typename RandomIt, typename UnaryPredicate>
+inline
+RandomIt parallel_find_if(RandomIt first, RandomIt last, UnaryPredicate pred)
+{
+   return parallel_find_if(default_thread_pool(), first, last, std::move(pred));
+}
+
+template <typename RandomIt, typename UnaryPredicate>
+inline
+bool parallel_any_of(RandomIt first, RandomIt last, UnaryPredicate pred)
+{
+   return parallel_any_of(default_thread_pool(), first, last, std::move(pred));
+}
+
+namespace pfis // parallel_find_internals
+{
+   template <typename RandomIt, typename UnaryPredicate>
+   RandomIt search_first(thread_pool& pool, RandomIt first, RandomIt last, UnaryPredicate pred, std::random_access_iterator_tag)
+   {
+      return parallel_find_if(pool, first, last, std::move(pred));
+   }
+
+   template <typename InputIt, typename UnaryPredicate>
+   InputIt search_first(thread_pool&, InputIt first, InputIt last, UnaryPredicate pred, std::input_iterator_tag)
+   {
+      return std::find_if(first, last, std::move(pred));
+   }
+}  // end of 'parallel_find_internals'
+
+   // sequence_wrap::find_first: {true, a copy of the first element satisfying 'pred'} or {false, value_type()},
+   // a vector is searched by parallel_find_if on 'pool' (sequentially unless it is large) under the lock of the sequence,
+   // UnaryPredicate (bool(const value_type&)) is called concurrently
+template <typename V, typename C, typename M, typename UnaryPredicate>
+inline
+typename sequence_wrap<V, C, M>::pair_result_type
+find_first(const sequence_wrap<V, C, M>& sequence, thread_pool& pool, UnaryPredicate pred)
+{
+   using namespace std;
+   using value_type = typename sequence_wrap<V, C, M>::value_type;
+   return sequence.inspect([&](const C& c) {
+      using category = typename iterator_traits<typename C::const_iterator>::iterator_category;
+      const auto i = pfis::search_first(pool, begin(c), end(c), pred, category{});
+      return (i!= end(c))? make_pair(true,*i) : make_pair(false,value_type());
+   });
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_PARALLEL_FIND_INCLUDED_
@@ -0,0 +1,377 @@
+#ifndef _THREAD_EX_PARALLEL_REGION_INCLUDED_
+#define _THREAD_EX_PARALLEL_REGION_INCLUDED_
+
+/**
+	\file 	te_parallel_region.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+#include <type_traits>
+#include <memory>
+#include <cassert>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_thread_unjoinable.h"
+#include "te_available_concurrency.h"
+
+/**
+   \brief a persistent team of threads running OpenMP-like parallel regions
+
+   Iterative jobs (stencils, k-means) which submit a batch of tasks to thread_pool per iteration and gather the futures
+   pay for allocations and wake-ups every iteration. A parallel region is entered once: the function is run by every thread of the team
+   and the iterations are synchronised by team_ctx::barrier, no task is created inside the region.
+   - the calling thread takes part in the region as the thread number 0 (the master)
+   - the barrier is a dissemination one: in round k the thread i signals the thread (i + 2^k) mod n and waits for its own signal,
+     so ceil(log2 n) rounds, no shared counter and every thread spins on its own cache line (sense and parity reversing make the flags reusable).
+     A thread spins for a while and then yields the core
+   - 'single' is run by the first thread which reaches it, 'master' by the thread number 0 only
+   - an exception thrown by a thread breaks the barriers of the region, it is rethrown by 'parallel_region' to the caller
+   - a region inside a region is run by a team of the only thread
+
+   The threads of a team are out of concurrency_governor, a barrier requires all of them to run at the same time.
+
+   \remark OpenMP 'parallel', 'barrier', 'single' and 'master' constructs
+   \remark "Algorithms for Scalable Synchronization on Shared-Memory Multiprocessors", J. Mellor-Crummey, M. Scott (dissemination barrier)
+   \example unit/test_parallel_region.cpp
+*/
+
+namespace thread_ex
+{
+
+class team_ctx;
+class worker_team;
+
+namespace pris // parallel_region_internals
+{
+   struct region_broken {};   // thrown by a barrier to unwind the threads of a region when one of them has failed
+
+   struct barrier_flag   // a flag per cache line (64 bytes), a waiting thread spins on its own line only
+   {
+      std::atomic_bool  value;
+      char              padding[64 - sizeof(std::atomic_bool)];
+   };
+
+   struct region_state
+   {
+      size_t                  team_size   {1};
+      size_t                  rounds      {0};     // ceil(log2(team_size)), the rounds of a barrier
+      size_t                  max_rounds  {0};     // the rounds of the largest team, flags of a thread are flags[thread*2*max_rounds]
+      std::unique_ptr<barrier_flag[]>  flags;      // [thread][parity][round], {nullptr} for a team of the only thread
+      void                    (*invoke)(void*, team_ctx&) {nullptr};
+      void*                   function    {nullptr};
+      std::atomic<size_t>     singles     {0};
+      std::atomic_bool        broken      {false};
+      std::atomic<size_t>     pending     {0};     // workers (the master is not counted) which have not left the region yet
+      std::mutex              error_mutex;
+      std::exception_ptr      error;
+   };
+
+      // the team the current thread runs a region for, {nullptr} out of regions
+   inline worker_team*& current_team() noexcept
+   {
+      static thread_local worker_team* team;
+      return team;
+   }
+
+   inline size_t barrier_rounds(size_t team_size) noexcept
+   {
+      size_t rounds = 0;
+      for(size_t distance = 1; distance < team_size; distance *= 2)
+         ++rounds;
+      return rounds;
+   }
+}  // end of 'parallel_region_internals'
+
+/**
+   \brief a view of the region for a thread of the team
+*/
+class team_ctx
+{
+public:
+      // iterations of waiting a barrier before the thread yields
+   static constexpr size_t spin_limit = 128;
+
+   size_t   thread_num() const noexcept   { return thread_num_; }
+   size_t   team_size() const noexcept    { return region_->team_size; }
+      // no thread of the team leaves the barrier until all of them have reached it
+   void     barrier();
+      // 'f' is run by the first thread which reaches it, the others wait for it at the implicit barrier
+   template <typename Function>
+   void     single(Function&&);
+      // 'f' is run by the thread number 0, there is no barrier
+   template <typename Function>
+   void     master(Function&&);
+
+   team_ctx(const team_ctx&)              = delete;
+   team_ctx& operator=(const team_ctx&)   = delete;
+
+private:
+   friend class worker_team;
+   team_ctx(pris::region_state& r, size_t n) noexcept : region_(&r), thread_num_(n) {}
+
+private:
+   pris::region_state*  region_;
+   size_t               thread_num_;
+   bool                 sense_      {true};
+   size_t               parity_     {0};
+   size_t               singles_    {0};
+};
+
+class worker_team
+{
+   using thread_container_type = std::vector<joined_thread>;
+   using unique_lock_type      = std::unique_lock<std::mutex>;
+
+public:
+      // 'n' threads including the one calling 'parallel_region'
+   explicit worker_team(size_t n = available_concurrency());
+   worker_team(const worker_team&)              = delete;
+   worker_team& operator=(const worker_team&)   = delete;
+   ~worker_team();
+
+      // the instance 'parallel_region' of the namespace runs on
+   static worker_team& global();
+
+   size_t   size() const noexcept;
+      // runs f(team_ctx&) by 'team_size' threads (no more than size()) and waits until all of them are done.
+      // regions of a team started by different threads are run one after another
+   template <typename Function>
+   void     parallel_region(size_t team_size, Function&&);
+
+private:
+   void     listening_thread(size_t);
+   void     run(pris::region_state&, size_t);
+
+private:
+   size_t                  size_          {1};
+   std::mutex              region_mutex_;       // a region at a time
+   std::mutex              mutex_;
+   std::condition_variable start_;
+   std::condition_variable done_;
+   size_t                  generation_    {0};  // guarded by mutex_, the number of regions started
+   bool                    stopping_      {false};
+   pris::region_state      region_;
+   thread_container_type   threads_;
+};
+
+inline
+void team_ctx::barrier()
+{
+   pris::region_state& r = *region_;
+   const size_t stride = 2*r.max_rounds;
+   pris::barrier_flag* const own = &r.flags[thread_num_*stride + parity_*r.max_rounds];
+   for(size_t k = 0, distance = 1; k < r.rounds; ++k, distance *= 2)
+   {
+      const size_t partner = (thread_num_ + distance) % r.team_size;
+      r.flags[partner*stride + parity_*r.max_rounds + k].value.store(sense_, std::memory_order_release);
+      for(size_t spins = 0; own[k].value.load(std::memory_order_acquire)!=sense_; ++spins)
+      {
+         if(r.broken.load(std::memory_order_relaxed))
+            throw pris::region_broken{};
+         if(spins >= spin_limit)
+            std::this_thread::yield();
+      }
+   }
+   if(1==parity_)
+      sense_ = !sense_;
+   parity_ = 1 - parity_;
+}
+
+template <typename Function>
+inline
+void team_ctx::single(Function&& f)
+{
+   size_t k = singles_++;
+   if(region_->singles.compare_exchange_strong(k, k+1))
+      f();
+   barrier();
+}
+
+template <typename Function>
+inline
+void team_ctx::master(Function&& f)
+{
+   if(0==thread_num_)
+      f();
+}
+
+inline
+worker_team::worker_team(size_t n)
+   : size_(n?n:1)
+{
+   region_.max_rounds = pris::barrier_rounds(size_);
+   if(region_.max_rounds)
+      region_.flags = std::make_unique<pris::barrier_flag[]>(size_*2*region_.max_rounds);
+#ifdef _MSC_VER
+   #pragma warning( push )
+   #pragma warning( disable: 4571 ) // Informational: catch(...) semantics changed since Visual C++ 7.1; structured exceptions (SEH) are no longer caught
+#endif
+   try
+   {
+      for(size_t i = 1; i < size_; ++i)
+         threads_.push_back(std::thread{&worker_team::listening_thread,this,i});
+   }
+   catch(...)
+   {
+      {  std::lock_guard<std::mutex> l(mutex_);
+         stopping_ = true;
+      }
+      start_.notify_all();
+      throw;
+   }
+#ifdef _MSC_VER
+   #pragma warning( pop )
+#endif
+}
+
+inline
+worker_team::~worker_team()
+{
+   {  std::lock_guard<std::mutex> l(mutex_);
+      stopping_ = true;
+   }
+   start_.notify_all();
+   thread_container_type{}.swap(threads_);
+}
+
+inline
+worker_team& worker_team::global()
+{
+   static worker_team the_team;
+   return the_team;
+}
+
+inline
+size_t worker_team::size() const noexcept
+{
+   return size_;
+}
+
+#ifdef _MSC_VER
+   #pragma warning( push )
+   #pragma warning( disable: 4571 ) // Informational: catch(...) semantics changed since Visual C++ 7.1; structured exceptions (SEH) are no longer caught
+#endif
+inline
+void worker_team::run(pris::region_state& r, size_t n)
+{
+   worker_team*& current = pris::current_team();
+   worker_team* const outer = current;
+   current = this;
+   team_ctx ctx {r, n};
+   try
+   {
+      r.invoke(r.function, ctx);
+   }
+   catch(const pris::region_broken&)
+   {
+   }
+   catch(...)
+   {
+      {  std::lock_guard<std::mutex> l(r.error_mutex);
+         if(!r.error)
+            r.error = std::current_exception();
+      }
+      r.broken = true;
+   }
+   current = outer;
+}
+#ifdef _MSC_VER
+   #pragma warning( pop )
+#endif
+
+inline
+void worker_team::listening_thread(size_t n)
+{
+   size_t seen {0};
+   for(;;)
+   {
+      {  unique_lock_type l(mutex_);
+         start_.wait(l, [this,&seen] { return generation_!=seen || stopping_; });
+         if(stopping_)
+            return;
+         seen = generation_;
+         if(n >= region_.team_size)
+            continue;   // the region is run by a smaller team
+      }
+      run(region_,n);
+      if(1==region_.pending.fetch_sub(1))
+      {
+         std::lock_guard<std::mutex> l(mutex_);
+         done_.notify_one();
+      }
+   }
+}
+
+template <typename Function>
+inline
+void worker_team::parallel_region(size_t team_size, Function&& f)
+{
+   using function_type = std::remove_reference_t<Function>;
+   auto invoke = [](void* p, team_ctx& ctx) { (*static_cast<function_type*>(p))(ctx); };
+
+   if(pris::current_team())
+   {  // nested region, the current thread is the whole team
+      pris::region_state nested;
+      nested.invoke   = invoke;
+      nested.function = const_cast<void*>(static_cast<const void*>(&f));
+      run(nested,0);
+      if(nested.error)
+         std::rethrow_exception(nested.error);
+      return;
+   }
+
+   std::lock_guard<std::mutex> region(region_mutex_);
+   {  std::lock_guard<std::mutex> l(mutex_);
+      region_.team_size = std::max<size_t>(1, std::min(team_size, size_));
+      region_.rounds    = pris::barrier_rounds(region_.team_size);
+      region_.invoke    = invoke;
+      region_.function  = const_cast<void*>(static_cast<const void*>(&f));
+      for(size_t i = 0; i < size_*2*region_.max_rounds; ++i)
+         region_.flags[i].value.store(false, std::memory_order_relaxed);  // a thread starts a region with the sense 'true'
+      region_.singles   = 0;
+      region_.broken    = false;
+      region_.pending   = region_.team_size - 1;
+      region_.error     = nullptr;
+      ++generation_;
+   }
+   if(region_.team_size > 1)
+      start_.notify_all();
+
+   run(region_,0);
+   {  unique_lock_type l(mutex_);
+      done_.wait(l, [this] { return 0==region_.pending.load(); });
+   }
+
+   if(region_.error)
+   {
+      std::exception_ptr e;
+      e.swap(region_.error);
+      std::rethrow_exception(e);
+   }
+}
+
+/**
+   \brief runs f(team_ctx&) by 'team_size' threads of worker_team::global(), the calling thread is the thread number 0
+*/
+template <typename Function>
+inline
+void parallel_region(size_t team_size, Function&& f)
+{
+   worker_team::global().parallel_region(team_size, std::forward<Function>(f));
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_PARALLEL_REGION_INCLUDED_
@@ -0,0 +1,211 @@
+#ifndef _THREAD_EX_PARALLEL_SCAN_INCLUDED_
+#define _THREAD_EX_PARALLEL_SCAN_INCLUDED_
+
+/**
+	\file 	te_parallel_scan.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <vector>
+#include <iterator>
+#include <functional>
+#include <exception>
+#include <type_traits>
+#include <algorithm>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_thread_pool.h"
+#include "te_runtime_concurrency.h"
+
+/**
+   \brief parallel prefix sums (std::partial_sum and std::exclusive_scan of C++17) of random-access ranges on a thread_pool
+
+   The two-pass blocked algorithm: the range is split into blocks, one per thread of runtime_concurrency
+   (no smaller than scan_min_block elements), then
+   - pass 1: the first block is scanned, the other ones are reduced to their sums, in parallel
+   - the carries of the blocks are the prefix sums of the block sums, sequentially (a handful of them)
+   - pass 2: every block but the first one is scanned starting with its carry, in parallel
+   Every element is read twice and written once. 'op' must be associative, it need not be commutative.
+   The output may be the input (in place). The calling thread scans a block as well, a worker of the pool calling it is
+   compensated (see blocking_section). An exception thrown by 'op' is rethrown once all the blocks are done.
+   'blocks' - the number of blocks, 0 (by default) means runtime_concurrency.
+
+   \remark "Prefix Sums and Their Applications", G. Blelloch
+   \remark "Structured Parallel Programming", M. McCool, A. Robison, J. Reinders, chapter 5.6 (scan)
+   \example unit/test_parallel_scan.cpp
+*/
+
+namespace thread_ex
+{
+
+   // the elements per block below which a block does not pay for its task
+constexpr size_t scan_min_block = 16*1024;
+
+namespace psis // parallel_scan_internals
+{
+#ifdef _MSC_VER
+   #pragma warning( push )
+   #pragma warning( disable: 4571 ) // Informational: catch(...) semantics changed since Visual C++ 7.1; structured exceptions (SEH) are no longer caught
+#endif
+      // f(b) for every block, the block 0 by the calling thread. Returns when all of them are done
+   template <typename Function>
+   void for_each_block(thread_pool& pool, size_t blocks, Function& f)
+   {
+      std::vector<std::future<void>> others;
+      others.reserve(blocks);
+      std::exception_ptr error;
+      try
+      {
+         for(size_t b = 1; b < blocks; ++b)
+            others.push_back(pool.submit([&f,b] { f(b); }));
+         f(0);
+      }
+      catch(...)
+      {
+         error = std::current_exception();
+      }
+      {  blocking_section blocking;
+         for(auto& o : others)
+            o.wait();   // the blocks refer to the caller's data
+      }
+      if(error)
+         std::rethrow_exception(error);
+      for(auto& o : others)
+         o.get();
+   }
+#ifdef _MSC_VER
+   #pragma warning( pop )
+#endif
+
+   template <typename RandomIt, typename T, typename BinaryOp>
+   T reduce(RandomIt first, RandomIt last, T init, BinaryOp& op)
+   {
+      for(; first!=last; ++first)
+         init = op(std::move(init), *first);
+      return init;
+   }
+
+      // the output may be the input: an element is read before its output is written.
+      // Returns the carry of the next block
+   template <typename RandomIt, typename OutputIt, typename T, typename BinaryOp>
+   T inclusive(RandomIt first, RandomIt last, OutputIt d_first, T carry, BinaryOp& op)
+   {
+      for(; first!=last; ++first, ++d_first)
+      {
+         carry = op(std::move(carry), *first);
+         *d_first = carry;
+      }
+      return carry;
+   }
+
+   template <typename RandomIt, typename OutputIt, typename T, typename BinaryOp>
+   T exclusive(RandomIt first, RandomIt last, OutputIt d_first, T carry, BinaryOp& op)
+   {
+      for(; first!=last; ++first, ++d_first)
+      {
+         T next = op(carry, *first);
+         *d_first = std::move(carry);
+         carry = std::move(next);
+      }
+      return carry;
+   }
+
+      // the number of blocks of 'n' elements, by runtime_concurrency if 'blocks' is 0
+   inline size_t blocks_of(size_t n, size_t blocks)
+   {
+      if(0==blocks)
+         blocks = runtime_concurrency(n?n:1, scan_min_block);
+      return std::max<size_t>(1, std::min(blocks, n));
+   }
+
+      // the scan of both kinds: 'exclusive' - the carry of the block 0 is 'init', otherwise the block 0 starts with its first element
+   template <bool Exclusive, typename RandomIt, typename OutputIt, typename T, typename BinaryOp>
+   OutputIt scan(thread_pool& pool, RandomIt first, RandomIt last, OutputIt d_first, T init, BinaryOp op, size_t blocks)
+   {
+      const size_t n = static_cast<size_t>(std::distance(first, last));
+      if(0==n)
+         return d_first;
+      blocks = blocks_of(n, blocks);
+      const size_t size = (n + blocks - 1) / blocks;
+      blocks = (n + size - 1) / size;
+      auto begin_of = [&](size_t b) { return first + static_cast<std::ptrdiff_t>(std::min(n, b*size)); };
+      auto output_of = [&](size_t b) { return d_first + static_cast<std::ptrdiff_t>(std::min(n, b*size)); };
+
+      auto scan_block = [&](size_t b, T carry) -> T {
+         return Exclusive? exclusive(begin_of(b), begin_of(b+1), output_of(b), std::move(carry), op)
+                         : inclusive(begin_of(b), begin_of(b+1), output_of(b), std::move(carry), op);
+      };
+      auto first_block = [&]() -> T {
+         if(Exclusive)
+            return scan_block(0, init);
+         T head = *first;     // the first element is the init of an inclusive scan
+         *d_first = head;
+         return inclusive(first + 1, begin_of(1), d_first + 1, std::move(head), op);
+      };
+      if(1==blocks)
+      {
+         first_block();
+         return d_first + static_cast<std::ptrdiff_t>(n);
+      }
+
+         // pass 1: the sums of the blocks but the last one, sums[0] is the carry of the block 1
+      std::vector<T> sums(blocks - 1, init);
+      auto pass1 = [&](size_t b) {
+         if(0==b)
+            sums[0] = first_block();
+         else if(b < blocks - 1)
+            sums[b] = psis::reduce(begin_of(b) + 1, begin_of(b+1), T(*begin_of(b)), op);
+      };
+      for_each_block(pool, blocks, pass1);
+      for(size_t b = 1; b < blocks - 1; ++b)
+         sums[b] = op(sums[b-1], sums[b]);
+
+         // pass 2: the blocks but the first one from their carries
+      auto pass2 = [&](size_t b) {
+         scan_block(b + 1, sums[b]);
+      };
+      for_each_block(pool, blocks - 1, pass2);
+      return d_first + static_cast<std::ptrdiff_t>(n);
+   }
+}  // end of 'parallel_scan_internals'
+
+   // std::partial_sum: d[i] = in[0] op ... op in[i]
+template <typename RandomIt, typename OutputIt, typename BinaryOp = std::plus<>>
+inline
+OutputIt parallel_inclusive_scan(thread_pool& pool, RandomIt first, RandomIt last, OutputIt d_first, BinaryOp op = {}, size_t blocks = 0)
+{
+   using value_type = typename std::iterator_traits<RandomIt>::value_type;
+   return psis::scan<false>(pool, first, last, d_first, value_type{}, std::move(op), blocks);
+}
+
+   // std::exclusive_scan: d[0] = init, d[i] = init op in[0] op ... op in[i-1]
+template <typename RandomIt, typename OutputIt, typename T, typename BinaryOp = std::plus<>>
+inline
+OutputIt parallel_exclusive_scan(thread_pool& pool, RandomIt first, RandomIt last, OutputIt d_first, T init, BinaryOp op = {}, size_t blocks = 0)
+{
+   return psis::scan<true>(pool, first, last, d_first, std::move(init), std::move(op), blocks);
+}
+
+   // the same on default_thread_pool()
+template <typename RandomIt, typename OutputIt, typename BinaryOp = std::plus<>>
+inline
+OutputIt parallel_inclusive_scan(RandomIt first, RandomIt last, OutputIt d_first, BinaryOp op = {})
+{
+   return parallel_inclusive_scan(default_thread_pool(), first, last, d_first, std::move(op));
+}
+
+template <typename RandomIt, typename OutputIt, typename T, typename BinaryOp = std::plus<>>
+inline
+OutputIt parallel_exclusive_scan(RandomIt first, RandomIt last, OutputIt d_first, T init, BinaryOp op = {})
+{
+   return parallel_exclusive_scan(default_thread_pool(), first, last, d_first, std::move(init), std::move(op));
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_PARALLEL_SCAN_INCLUDED_
@@ -110,6 +110,21 @@ pop(STDCONTAINERADAPTER& c, typename STDCONTAINERADAPTER::value_type& out, MUTEX
       throw empty_error{};
 }
 
+/**
+   moves up to 'max_count' elements from the top/front of 'c' into 'out' (std::queue keeps the order)
+   \retval the number of moved elements, 0 if 'c' is empty
+*/
+template<typename STDCONTAINERADAPTER>
+inline
+size_t
+pop(STDCONTAINERADAPTER& c, STDCONTAINERADAPTER& out, size_t max_count)
+{
+   size_t n {0};
+   for(; n<max_count && !c.empty(); ++n, c.pop())
+      out.push(std::move(first::get(c)));
+   return n;
+}
+
 template<typename ELEMENT_T, typename STDCONTAINERADAPTER, typename MUTEX, typename = typename MUTEX::native_handle_type>
 inline
 std::unique_ptr<typename STDCONTAINERADAPTER::value_type>
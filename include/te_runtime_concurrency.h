@@ -15,6 +15,8 @@
 #include <algorithm>
 #include "te_compiler_warning_rollback.h"
 #include "te_compiler.h"
+#include "te_concurrency_governor.h"
+#include "te_available_concurrency.h"
 
 
 /**
@@ -25,6 +27,8 @@
    On a multicore system it might be the number of CPU cores, for example. 
    This is only a hint, and the function might return 0 if this information is not available,
    but it can be a useful guide for splitting a task among threads.
+   It is the number of CPUs of the host though, not the CPU quota or the affinity mask of a process in a container,
+   that is why available_concurrency() is used instead.
 
    \remark "C++ Concurrency in Action", Anthony Williams, chapter 2.4, page 28
 */
@@ -51,16 +55,18 @@ namespace thread_ex
    In the worst case, if multiple threads call a function that uses runtime_concurrency() for scaling at the same time,there will be huge oversubscription. 
    std::async() avoids this problem because the library is aware of all calls and can schedule appropriately. 
    Careful use of thread pools can also avoid this problem.
+   That is why the number of hardware threads is limited by the tokens of concurrency_governor::global() 
+   which are not in use by thread pools and call_async at the moment of the call.
 */
 inline size_t runtime_concurrency(const size_t total_num, const size_t min_num)
 {
    assert(min_num);
 
    const size_t max_num       = (total_num+min_num-1)/min_num;
-   const size_t hardware_num  = std::thread::hardware_concurrency();
-   assert(hardware_num);
+   const size_t hardware_num  = available_concurrency();
+   const size_t free_num      = std::min(hardware_num,concurrency_governor::global().available());
 
-   return std::min(hardware_num?hardware_num:1,max_num);
+   return std::min(free_num?free_num:1,max_num);
 }
 
 } // namespace thread_ex
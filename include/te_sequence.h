@@ -99,6 +99,11 @@ namespace thread_ex
       template <typename UnaryPredicate>
       size_t move(container_type& other, UnaryPredicate);
 
+         // Calls f(const container_type&) under the lock and returns its result,
+         // e.g. an algorithm of another header (see find_first of te_parallel_find.h)
+      template <typename Function>
+      typename std::result_of<Function(const container_type&)>::type inspect(Function) const;
+
          // Applies the given UnaryFunction to the every element in the sequence, in order.
          // returns function object of UnaryFunction type
       template <typename UnaryFunction> // void fun(const Type &a);
@@ -282,6 +287,17 @@ protected:
       });        
    }
 
+   template <typename V, typename C, typename M>
+   template <typename Function>
+   inline
+   typename std::result_of<Function(const typename sequence_wrap<V, C, M>::container_type&)>::type
+   sequence_wrap<V, C, M>::inspect(Function f) const
+   {
+      return call_under_lock([&]() -> decltype(auto) {
+         return f(container_);
+      });
+   }
+
    template <typename V, typename C, typename M>
    template <typename UnaryPredicate> // UnaryPredicate - lambda or functor with the signature: bool(const value_type&)
    inline
@@ -0,0 +1,230 @@
+#ifndef _THREAD_EX_STOP_TOKEN_INCLUDED_
+#define _THREAD_EX_STOP_TOKEN_INCLUDED_
+
+/**
+	\file 	te_stop_token.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <utility>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+
+/**
+   \brief a cooperative request to stop: stop_source, stop_token and stop_callback of C++20 for C++14
+
+   - stop_source requests a stop, the request is seen by all the tokens of the source (of its copies as well)
+   - stop_token is checked by the stoppable code: 'stop_requested'
+   - stop_callback registers a function run by the thread which requests the stop, or at once if the stop is requested already.
+     Its destructor unregisters the function and waits for it if it is running on another thread at the moment
+   A blocking wait is made stoppable by a callback which wakes up the waiting thread,
+   see stoppable_thread (te_thread_unjoinable.h) and threadsafe_queue::wait_pop (te_container.h).
+
+   \remark http://en.cppreference.com/w/cpp/thread/stop_token
+   \example unit/test_stop_token.cpp
+*/
+
+namespace thread_ex
+{
+
+class stop_token;
+class stop_source;
+
+namespace stis // stop_token_internals
+{
+   struct callback_base
+   {
+      virtual void run() noexcept = 0;
+
+      callback_base*    prev     {nullptr};
+      callback_base*    next     {nullptr};
+      bool              linked   {false};    // guarded by stop_state::mutex_
+   protected:
+      ~callback_base() = default;
+   };
+
+   class stop_state
+   {
+      using unique_lock_type = std::unique_lock<std::mutex>;
+
+   public:
+      bool     stop_requested() const noexcept   { return requested_.load(std::memory_order_acquire); }
+      bool     stop_possible() const noexcept    { return stop_requested() || sources_.load(std::memory_order_acquire); }
+      void     attach() noexcept                 { sources_.fetch_add(1, std::memory_order_relaxed); }
+      void     detach() noexcept                 { sources_.fetch_sub(1, std::memory_order_acq_rel); }
+
+         // runs the callbacks in order of registration, false - the stop has been requested already
+      bool     request_stop();
+         // false - the stop has been requested already, the caller runs the callback itself
+      bool     add(callback_base*);
+         // waits for the callback if it is running on another thread
+      void     remove(callback_base*);
+
+   private:
+      std::atomic_bool           requested_  {false};
+      std::atomic<size_t>        sources_    {0};
+      std::mutex                 mutex_;
+      std::condition_variable    finished_;
+      callback_base*             head_       {nullptr};
+      callback_base*             tail_       {nullptr};
+      callback_base*             running_    {nullptr};
+      std::thread::id            runner_;
+   };
+
+   inline
+   bool stop_state::request_stop()
+   {
+      unique_lock_type l(mutex_);
+      if(requested_.load(std::memory_order_relaxed))
+         return false;
+      requested_.store(true, std::memory_order_release);
+      runner_ = std::this_thread::get_id();
+      while(head_)
+      {
+         callback_base* c = head_;
+         head_ = c->next;
+         (head_? head_->prev : tail_) = nullptr;
+         c->linked = false;
+         running_ = c;
+         l.unlock();
+         c->run();
+         l.lock();
+         running_ = nullptr;
+         finished_.notify_all();
+      }
+      return true;
+   }
+
+   inline
+   bool stop_state::add(callback_base* c)
+   {
+      std::lock_guard<std::mutex> l(mutex_);
+      if(requested_.load(std::memory_order_relaxed))
+         return false;
+      c->prev = tail_;
+      c->next = nullptr;
+      (tail_? tail_->next : head_) = c;
+      tail_ = c;
+      c->linked = true;
+      return true;
+   }
+
+   inline
+   void stop_state::remove(callback_base* c)
+   {
+      unique_lock_type l(mutex_);
+      if(c->linked)
+      {
+         (c->prev? c->prev->next : head_) = c->next;
+         (c->next? c->next->prev : tail_) = c->prev;
+         c->linked = false;
+         return;
+      }
+         // a callback destroying itself is not waited for
+      if(running_==c && runner_!=std::this_thread::get_id())
+         finished_.wait(l, [this,c] { return running_!=c; });
+   }
+}  // end of 'stop_token_internals'
+
+class stop_token
+{
+public:
+   stop_token() noexcept = default;   // no stop is possible
+
+   bool  stop_requested() const noexcept  { return state_ && state_->stop_requested(); }
+      // false - there is no source which can request a stop
+   bool  stop_possible() const noexcept   { return state_ && state_->stop_possible(); }
+
+   friend bool operator==(const stop_token& a, const stop_token& b) noexcept  { return a.state_==b.state_; }
+   friend bool operator!=(const stop_token& a, const stop_token& b) noexcept  { return a.state_!=b.state_; }
+
+private:
+   friend class stop_source;
+   template <typename Callback> friend class stop_callback;
+   explicit stop_token(std::shared_ptr<stis::stop_state> s) noexcept : state_(std::move(s)) {}
+
+private:
+   std::shared_ptr<stis::stop_state> state_;
+};
+
+   // the tag of a stop_source without a stop state (see std::nostopstate)
+struct nostopstate_t { explicit nostopstate_t() = default; };
+constexpr nostopstate_t nostopstate {};
+
+class stop_source
+{
+public:
+   stop_source() : state_(std::make_shared<stis::stop_state>()) { state_->attach(); }
+   explicit stop_source(nostopstate_t) noexcept {}   // no stop is possible, nothing is allocated
+   stop_source(const stop_source& other) noexcept : state_(other.state_) { if(state_) state_->attach(); }
+   stop_source(stop_source&&) noexcept = default;
+   stop_source& operator=(stop_source other) noexcept   { swap(other); return *this; }
+   ~stop_source()                                     { if(state_) state_->detach(); }
+
+      // false - the stop has been requested already (by this source or by a copy of it)
+   bool        request_stop()                { return state_ && state_->request_stop(); }
+   bool        stop_requested() const noexcept  { return state_ && state_->stop_requested(); }
+   stop_token  get_token() const noexcept    { return stop_token{state_}; }
+   void        swap(stop_source& other) noexcept   { state_.swap(other.state_); }
+
+private:
+   std::shared_ptr<stis::stop_state> state_;
+};
+
+/**
+   \brief 'Callback' is run once a stop of the token is requested. It must not throw
+*/
+template <typename Callback>
+class stop_callback : stis::callback_base
+{
+public:
+   using callback_type = Callback;
+
+   template <typename C>
+   stop_callback(const stop_token&, C&&);
+   stop_callback(const stop_callback&)             = delete;
+   stop_callback& operator=(const stop_callback&)  = delete;
+   ~stop_callback();
+
+private:
+   void  run() noexcept override { callback_(); }
+
+private:
+   Callback                            callback_;
+   std::shared_ptr<stis::stop_state>   state_;
+};
+
+template <typename Callback>
+template <typename C>
+inline
+stop_callback<Callback>::stop_callback(const stop_token& token, C&& c)
+   : callback_(std::forward<C>(c)), state_(token.state_)
+{
+   if(state_ && !state_->add(this))
+   {
+      state_.reset();
+      callback_();
+   }
+}
+
+template <typename Callback>
+inline
+stop_callback<Callback>::~stop_callback()
+{
+   if(state_)
+      state_->remove(this);
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_STOP_TOKEN_INCLUDED_
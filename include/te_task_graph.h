@@ -0,0 +1,235 @@
+#ifndef _THREAD_EX_TASK_GRAPH_INCLUDED_
+#define _THREAD_EX_TASK_GRAPH_INCLUDED_
+
+/**
+	\file 	te_task_graph.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+#include <cassert>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_thread_pool.h"
+
+/**
+   \brief a graph of tasks and dependencies between them, declared once and run many times on a thread_pool
+
+   Waves of 'submit' with a barrier (waiting for all the futures) between them leave the workers idle
+   while the longest task of a wave is running. A node of the graph is released the moment its last predecessor is done:
+   - every node has an atomic counter of its predecessors, a finished node decrements the counters of its successors
+   - the successor whose counter reaches zero is run by the same worker at once, the other ready ones are posted to the pool
+   - there are no futures and no allocations per run but the posted tasks
+   - an exception thrown by a node skips the nodes not started yet, 'run' rethrows the first one
+   'run' blocks the caller until all the nodes are done, a worker of the pool calling it is compensated (see blocking_section).
+   A graph is run by one thread at a time; it must not be modified while it is running.
+
+   \remark "Taskflow: A Lightweight Parallel and Heterogeneous Task Graph Computing System", T.-W. Huang et al.
+   \remark https://www.threadingbuildingblocks.org/docs/help/reference/flow_graph.html (continue_node)
+   \example unit/test_task_graph.cpp
+*/
+
+namespace thread_ex
+{
+
+class task_graph
+{
+   struct node
+   {
+      std::function<void()>   work;
+      std::vector<size_t>     successors;
+      size_t                  predecessors {0};
+   };
+
+   using unique_lock_type = std::unique_lock<std::mutex>;
+
+public:
+   using node_id = size_t;
+   static constexpr node_id no_node = static_cast<node_id>(-1);
+
+   task_graph() = default;
+   task_graph(const task_graph&)              = delete;
+   task_graph& operator=(const task_graph&)   = delete;
+
+      // f() is the work of the node
+   template <typename Function>
+   node_id  add(Function&&);
+      // 'after' is not started until 'before' is done. std::out_of_range - there is no such node
+   void     precede(node_id before, node_id after);
+   size_t   size() const noexcept  { return nodes_.size(); }
+
+      // runs all the nodes on 'pool' and waits for them. std::logic_error - the dependencies have a cycle
+   void     run(thread_pool& pool);
+
+private:
+   void     validate();
+   void     execute(node_id);
+   bool     finish();    // true - the last node of the run is done
+
+private:
+   std::vector<node>                         nodes_;
+   std::vector<node_id>                      roots_;
+   bool                                      validated_  {false};
+      // the state of a run
+   thread_pool*                              pool_       {nullptr};
+   std::unique_ptr<std::atomic<size_t>[]>    pending_;   // predecessors not done yet, per node
+   std::atomic<size_t>                       remaining_  {0};
+   std::atomic_bool                          failed_     {false};
+   std::exception_ptr                        error_;     // the first one, written by the failed node
+   std::mutex                                mutex_;
+   std::condition_variable                   done_;
+   bool                                      finished_   {true};  // guarded by mutex_
+};
+
+template <typename Function>
+inline
+task_graph::node_id task_graph::add(Function&& f)
+{
+   nodes_.push_back(node{std::function<void()>{std::forward<Function>(f)}, {}, 0});
+   validated_ = false;
+   return nodes_.size() - 1;
+}
+
+inline
+void task_graph::precede(node_id before, node_id after)
+{
+   if(before >= nodes_.size() || after >= nodes_.size())
+      throw std::out_of_range("task_graph: no such node");
+   nodes_[before].successors.push_back(after);
+   ++nodes_[after].predecessors;
+   validated_ = false;
+}
+
+inline
+void task_graph::validate()
+{
+   if(validated_)
+      return;
+      // Kahn's algorithm: all the nodes are reached from the roots unless there is a cycle
+   roots_.clear();
+   std::vector<size_t> counts(nodes_.size());
+   std::vector<node_id> ready;
+   for(node_id i = 0; i < nodes_.size(); ++i)
+   {
+      counts[i] = nodes_[i].predecessors;
+      if(0==counts[i])
+         roots_.push_back(i);
+   }
+   ready = roots_;
+   size_t reached {0};
+   while(!ready.empty())
+   {
+      const node_id n = ready.back();
+      ready.pop_back();
+      ++reached;
+      for(node_id s : nodes_[n].successors)
+         if(0==--counts[s])
+            ready.push_back(s);
+   }
+   if(reached!=nodes_.size())
+      throw std::logic_error("task_graph: the dependencies have a cycle");
+
+   pending_.reset(new std::atomic<size_t>[nodes_.size()]);
+   validated_ = true;
+}
+
+inline
+void task_graph::run(thread_pool& pool)
+{
+   validate();
+   if(nodes_.empty())
+      return;
+
+   for(node_id i = 0; i < nodes_.size(); ++i)
+      pending_[i].store(nodes_[i].predecessors, std::memory_order_relaxed);
+   pool_ = &pool;
+   failed_.store(false, std::memory_order_relaxed);
+   error_ = nullptr;
+   {  std::lock_guard<std::mutex> l(mutex_);
+      assert(finished_ && "a graph is run by one thread at a time");
+      finished_ = false;
+   }
+   remaining_.store(nodes_.size(), std::memory_order_release);
+
+   for(node_id r : roots_)
+      pool.post([this,r] { execute(r); });
+
+   {  blocking_section blocking;
+      unique_lock_type l(mutex_);
+      done_.wait(l, [this] { return finished_; });
+   }
+   pool_ = nullptr;
+   if(error_)
+      std::rethrow_exception(error_);
+}
+
+#ifdef _MSC_VER
+   #pragma warning( push )
+   #pragma warning( disable: 4571 ) // Informational: catch(...) semantics changed since Visual C++ 7.1; structured exceptions (SEH) are no longer caught
+#endif
+inline
+void task_graph::execute(node_id id)
+{
+   while(no_node!=id)
+   {
+      node& n = nodes_[id];
+      if(!failed_.load(std::memory_order_acquire))
+      {
+         try
+         {
+            n.work();
+         }
+         catch(...)
+         {
+            if(!failed_.exchange(true, std::memory_order_acq_rel))
+               error_ = std::current_exception();
+         }
+      }
+
+      node_id next {no_node};   // run by this worker, the cache is warm with the data of its predecessor
+      for(node_id s : n.successors)
+      {
+         if(1!=pending_[s].fetch_sub(1, std::memory_order_acq_rel))
+            continue;
+         if(no_node==next)
+            next = s;
+         else
+            pool_->post([this,s] { execute(s); });
+      }
+      if(finish())
+         return;
+      id = next;
+   }
+}
+#ifdef _MSC_VER
+   #pragma warning( pop )
+#endif
+
+inline
+bool task_graph::finish()
+{
+   if(1!=remaining_.fetch_sub(1, std::memory_order_acq_rel))
+      return false;
+      // notified under the lock: 'run' may return and the graph may be gone right after the lock is released
+   std::lock_guard<std::mutex> l(mutex_);
+   finished_ = true;
+   done_.notify_all();
+   return true;
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_TASK_GRAPH_INCLUDED_
@@ -0,0 +1,318 @@
+#ifndef _THREAD_EX_THREAD_BUILDER_INCLUDED_
+#define _THREAD_EX_THREAD_BUILDER_INCLUDED_
+
+/**
+	\file 	te_thread_builder.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <memory>
+#include <functional>
+#include <string>
+#include <utility>
+#include <tuple>
+#include <type_traits>
+#include <system_error>
+#include <exception>
+#include <algorithm>
+#ifdef _WIN32
+   #ifndef NOMINMAX
+      #define NOMINMAX
+   #endif
+   #include <windows.h>
+   #include <process.h>
+#else
+   #include <pthread.h>
+   #include <sched.h>
+   #include <unistd.h>
+   #include <limits.h>
+#endif
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_thread_unjoinable.h"
+
+/**
+   \brief a thread started with attributes std::thread has no way to set: stack size, name and scheduling policy
+
+   thread_builder collects the attributes, 'spawn' starts native_thread (a subset of std::thread interface) with them:
+   - stack size: pthread_attr_setstacksize, rounded up to the page size and PTHREAD_STACK_MIN (Windows: the reserved size of _beginthreadex)
+   - name: pthread_setname_np, seen by 'top -H', 'perf' and debuggers; Linux keeps 15 characters (Windows: SetThreadDescription, if available)
+   - scheduling policy and priority: explicit pthread scheduling attributes, realtime policies usually need privileges.
+     SCHED_BATCH and SCHED_IDLE are set by the new thread itself (Windows: SetThreadPriority by the new thread)
+   A thread which cannot be started with the attributes is reported by std::system_error, like std::thread does.
+
+   thread_pool::start takes a builder for its workers, the workers are named "<name>/<index>".
+
+   \remark https://man7.org/linux/man-pages/man3/pthread_attr_init.3.html
+   \example unit/test_thread_builder.cpp
+*/
+
+namespace thread_ex
+{
+
+class thread_builder;
+
+enum class sched_policy
+{
+    inherit       // the policy and the priority of the creating thread
+   ,other         // SCHED_OTHER, the default time-sharing one
+   ,batch         // SCHED_BATCH, CPU-bound non-interactive work (Linux only)
+   ,idle          // SCHED_IDLE, the lowest priority (Linux only)
+   ,fifo          // SCHED_FIFO, realtime
+   ,round_robin   // SCHED_RR, realtime
+};
+
+namespace tbis // thread_builder_internals
+{
+   struct job
+   {
+      virtual void run() = 0;
+      virtual ~job() {}
+      std::string name;
+         // the scheduling set by the thread itself, the attributes of a thread cannot carry it
+      bool        self_scheduled {false};
+      int         policy   {0};
+      int         priority {0};
+   };
+
+   template <typename Function, typename... Args>
+   struct job_impl : job
+   {
+      job_impl(Function&& f, Args&&... args) : f_(std::move(f)), args_(std::move(args)...) {}
+      void run() override { thread_ex::apply(std::ref(f_), std::move(args_)); }   // std::ref(f)(...) is INVOKE (pointers to members are supported)
+   private:
+      Function             f_;
+      std::tuple<Args...>  args_;
+   };
+
+   inline void set_current_name(const std::string& name)
+   {
+      if(name.empty())
+         return;
+#if defined(_WIN32)
+      using set_description_type = HRESULT (WINAPI*)(HANDLE, PCWSTR);
+      const auto set_description = reinterpret_cast<set_description_type>(::GetProcAddress(::GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription"));
+      if(set_description)
+         set_description(::GetCurrentThread(), std::wstring(name.begin(), name.end()).c_str());
+#elif defined(__APPLE__)
+      ::pthread_setname_np(name.c_str());
+#elif defined(__linux__)
+      ::pthread_setname_np(::pthread_self(), name.substr(0, 15).c_str());   // 16 bytes with the terminating zero
+#endif
+   }
+
+#ifdef _WIN32
+   inline unsigned __stdcall entry(void* p) noexcept
+#else
+   inline void* entry(void* p) noexcept
+#endif
+   {  // an exception thrown by the function terminates the program, as std::thread does
+      std::unique_ptr<job> j {static_cast<job*>(p)};
+      set_current_name(j->name);
+      if(j->self_scheduled)
+      {
+#ifdef _WIN32
+         ::SetThreadPriority(::GetCurrentThread(), j->priority);
+#else
+         sched_param param {};
+         param.sched_priority = j->priority;
+         ::pthread_setschedparam(::pthread_self(), j->policy, &param);
+#endif
+      }
+      j->run();
+      return 0;
+   }
+}  // end of 'thread_builder_internals'
+
+/**
+   \brief a thread started by thread_builder. As std::thread, a joinable one must be joined or detached before it is destroyed
+*/
+class native_thread
+{
+public:
+#ifdef _WIN32
+   using native_handle_type = HANDLE;
+#else
+   using native_handle_type = pthread_t;
+#endif
+
+   native_thread() noexcept = default;
+   native_thread(native_thread&& other) noexcept : handle_(other.handle_), joinable_(other.joinable_) { other.joinable_ = false; }
+   native_thread& operator=(native_thread&&) noexcept;
+   native_thread(const native_thread&)             = delete;
+   native_thread& operator=(const native_thread&)  = delete;
+   ~native_thread()                                { if(joinable_) std::terminate(); }
+
+   bool                 joinable() const noexcept  { return joinable_; }
+   void                 join();
+   void                 detach();
+   native_handle_type   native_handle() noexcept   { return handle_; }
+
+private:
+   friend class thread_builder;
+   explicit native_thread(native_handle_type h) noexcept : handle_(h), joinable_(true) {}
+
+private:
+   native_handle_type   handle_     {};
+   bool                 joinable_   {false};
+};
+
+inline
+native_thread& native_thread::operator=(native_thread&& other) noexcept
+{
+   if(joinable_)
+      std::terminate();
+   handle_   = other.handle_;
+   joinable_ = other.joinable_;
+   other.joinable_ = false;
+   return *this;
+}
+
+inline
+void native_thread::join()
+{
+   if(!joinable_)
+      throw std::system_error(std::make_error_code(std::errc::invalid_argument));
+#ifdef _WIN32
+   if(::GetThreadId(handle_)==::GetCurrentThreadId())
+      throw std::system_error(std::make_error_code(std::errc::resource_deadlock_would_occur));
+   ::WaitForSingleObject(handle_, INFINITE);
+   ::CloseHandle(handle_);
+#else
+   if(const int e = ::pthread_join(handle_, nullptr))
+      throw std::system_error(e, std::system_category());
+#endif
+   joinable_ = false;
+}
+
+inline
+void native_thread::detach()
+{
+   if(!joinable_)
+      throw std::system_error(std::make_error_code(std::errc::invalid_argument));
+#ifdef _WIN32
+   ::CloseHandle(handle_);
+#else
+   if(const int e = ::pthread_detach(handle_))
+      throw std::system_error(e, std::system_category());
+#endif
+   joinable_ = false;
+}
+
+using joined_native_thread = thread_unjoinable<details_::join_policy, native_thread>;
+
+class thread_builder
+{
+public:
+      // 0 - the default stack size of the system
+   thread_builder&      stack_size(size_t bytes) noexcept   { stack_size_ = bytes; return *this; }
+   thread_builder&      name(std::string n)                 { name_ = std::move(n); return *this; }
+      // 'priority' is sched_param::sched_priority (1..99 for the realtime policies on Linux, 0 for the others)
+   thread_builder&      policy(sched_policy p, int priority = 0) noexcept  { policy_ = p; priority_ = priority; return *this; }
+
+   size_t               stack_size() const noexcept   { return stack_size_; }
+   const std::string&   name() const noexcept         { return name_; }
+   sched_policy         policy() const noexcept       { return policy_; }
+   int                  priority() const noexcept     { return priority_; }
+
+      // the same attributes, the name is suffixed by "/<index>" (a worker of a group)
+   thread_builder       indexed(size_t) const;
+
+      // starts f(args...) on a new thread, the function and the arguments are moved (copied) as by std::thread.
+      // std::system_error - the thread cannot be started with the attributes
+   template <typename Function, typename... Args>
+   native_thread        spawn(Function&&, Args&&...) const;
+
+private:
+   size_t         stack_size_ {0};
+   std::string    name_;
+   sched_policy   policy_     {sched_policy::inherit};
+   int            priority_   {0};
+};
+
+inline
+thread_builder thread_builder::indexed(size_t i) const
+{
+   thread_builder b {*this};
+   if(!name_.empty())
+      b.name_ += "/" + std::to_string(i);
+   return b;
+}
+
+template <typename Function, typename... Args>
+inline
+native_thread thread_builder::spawn(Function&& f, Args&&... args) const
+{
+   using job_type = tbis::job_impl<std::decay_t<Function>, std::decay_t<Args>...>;
+   std::unique_ptr<tbis::job> j {new job_type(std::decay_t<Function>{std::forward<Function>(f)}, std::decay_t<Args>{std::forward<Args>(args)}...)};
+   j->name = name_;
+
+#ifdef _WIN32
+   if(sched_policy::inherit!=policy_)
+   {
+      j->self_scheduled = true;
+      j->priority       = priority_;
+   }
+   unsigned id {0};
+   const auto h = ::_beginthreadex(nullptr, static_cast<unsigned>(stack_size_), &tbis::entry, j.get(), stack_size_? STACK_SIZE_PARAM_IS_A_RESERVATION : 0, &id);
+   if(!h)
+      throw std::system_error(errno, std::generic_category());
+   j.release();
+   return native_thread{reinterpret_cast<HANDLE>(h)};
+#else
+   pthread_attr_t attr;
+   if(const int e = ::pthread_attr_init(&attr))
+      throw std::system_error(e, std::system_category());
+   std::unique_ptr<pthread_attr_t, int(*)(pthread_attr_t*)> attr_guard {&attr, &::pthread_attr_destroy};
+
+   int e {0};
+   if(stack_size_)
+   {
+      const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+      const size_t size = std::max<size_t>(stack_size_, PTHREAD_STACK_MIN);
+      e = ::pthread_attr_setstacksize(&attr, (size + page - 1) / page * page);
+   }
+   if(!e && sched_policy::inherit!=policy_)
+   {
+      int native {SCHED_OTHER};
+      switch(policy_)
+      {
+#if defined(SCHED_BATCH) && defined(SCHED_IDLE)
+            // not accepted by pthread_attr_setschedpolicy, the thread sets them itself (no privileges are needed)
+         case sched_policy::batch:        native = SCHED_BATCH;   break;
+         case sched_policy::idle:         native = SCHED_IDLE;    break;
+#endif
+         case sched_policy::fifo:         native = SCHED_FIFO;    break;
+         case sched_policy::round_robin:  native = SCHED_RR;      break;
+         default:                         native = SCHED_OTHER;   break;
+      }
+      const bool attributed = SCHED_OTHER==native || SCHED_FIFO==native || SCHED_RR==native;
+      j->self_scheduled = !attributed;
+      j->policy         = native;
+      j->priority       = priority_;
+      if(attributed)
+      {
+         sched_param param {};
+         param.sched_priority = priority_;
+         e = ::pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+         if(!e) e = ::pthread_attr_setschedpolicy(&attr, native);
+         if(!e) e = ::pthread_attr_setschedparam(&attr, &param);
+      }
+   }
+   pthread_t handle;
+   if(!e) e = ::pthread_create(&handle, &attr, &tbis::entry, j.get());
+   if(e)
+      throw std::system_error(e, std::system_category());
+   j.release();
+   return native_thread{handle};
+#endif
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_THREAD_BUILDER_INCLUDED_
@@ -0,0 +1,191 @@
+#ifndef _THREAD_EX_THREAD_CACHE_INCLUDED_
+#define _THREAD_EX_THREAD_CACHE_INCLUDED_
+
+/**
+	\file 	te_thread_cache.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <memory>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <utility>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+
+/**
+   \brief an elastic group of cached threads, every function executed by it starts running at once
+
+   std::async(std::launch::async, ...) creates and destroys an OS thread per call. thread_pool reuses its threads,
+   but a task waits in the queue while all the workers are busy, so it does not guarantee the task runs concurrently with the caller.
+   thread_cache keeps the threads which have completed their functions for a while ('keep_alive'):
+   - a function is handed over to an idle cached thread, if there is one
+   - otherwise a new thread is started for it, there is no queue of pending functions
+   - a thread idle for longer than 'keep_alive' exits
+
+   \remark java.util.concurrent.Executors.newCachedThreadPool
+   \example unit/test_thread_cache.cpp
+*/
+
+namespace thread_ex
+{
+
+class thread_cache
+{
+   struct job
+   {
+      virtual void run() = 0;
+      virtual ~job() {}
+   };
+
+   template <typename Function>
+   struct job_impl : job
+   {
+      explicit job_impl(Function&& f) : f_(std::move(f)) {}
+      void run() override { f_(); }
+   private:
+      Function f_;
+   };
+
+   using job_ptr           = std::unique_ptr<job>;
+   using unique_lock_type  = std::unique_lock<std::mutex>;
+
+public:
+   explicit thread_cache(std::chrono::milliseconds keep_alive = std::chrono::seconds(10));
+   thread_cache(const thread_cache&)              = delete;
+   thread_cache& operator=(const thread_cache&)   = delete;
+      // waits for all the functions in progress
+   ~thread_cache();
+
+      // 'f' is a movable callable without parameters, it starts running before 'execute' returns or soon after
+   template <typename Function>
+   void     execute(Function&&);
+
+   size_t   size() const;    // threads, both busy and idle
+   size_t   idle() const;
+
+private:
+   void     spawn(job_ptr);
+   void     listening_thread(job_ptr);
+
+private:
+   const std::chrono::milliseconds  keep_alive_;
+   mutable std::mutex               mutex_;
+   std::condition_variable          has_job_;
+   std::queue<job_ptr>              jobs_;         // handed over to the idle threads, never more than 'idle_'
+   size_t                           idle_       {0};
+   bool                             stopping_   {false};
+   std::vector<std::thread>         threads_;
+   std::vector<std::thread::id>     retired_;      // the threads which have left, to be joined
+};
+
+inline
+thread_cache::thread_cache(std::chrono::milliseconds keep_alive)
+   : keep_alive_(keep_alive)
+{
+}
+
+inline
+thread_cache::~thread_cache()
+{
+   std::vector<std::thread> threads;
+   {  std::lock_guard<std::mutex> l(mutex_);
+      stopping_ = true;
+      threads.swap(threads_);
+   }
+   has_job_.notify_all();
+   for(auto& t : threads)
+      t.join();
+}
+
+template <typename Function>
+inline
+void thread_cache::execute(Function&& f)
+{
+   job_ptr j {new job_impl<std::decay_t<Function>>(std::decay_t<Function>{std::forward<Function>(f)})};
+   {  std::lock_guard<std::mutex> l(mutex_);
+      if(jobs_.size() < idle_)
+      {  // every idle thread takes a single job, there is a free one
+         jobs_.push(std::move(j));
+      }
+   }
+   if(j)
+      spawn(std::move(j));
+   else
+      has_job_.notify_one();
+}
+
+inline
+void thread_cache::spawn(job_ptr j)
+{
+   std::lock_guard<std::mutex> l(mutex_);
+   for(const auto& id : retired_)
+   {
+      auto retired = std::find_if(threads_.begin(), threads_.end(), [&id](const std::thread& t) { return id==t.get_id(); });
+      retired->join();  // it has already left the loop
+      threads_.erase(retired);
+   }
+   retired_.clear();
+   threads_.push_back(std::thread{&thread_cache::listening_thread,this,std::move(j)});
+}
+
+inline
+void thread_cache::listening_thread(job_ptr j)
+{
+   for(;;)
+   {
+      j->run();
+      j.reset();
+
+      unique_lock_type l(mutex_);
+      ++idle_;
+      has_job_.wait_for(l, keep_alive_, [this] { return !jobs_.empty() || stopping_; });
+      --idle_;
+      if(jobs_.empty())
+      {  // not needed any longer
+         if(!stopping_)
+            retired_.push_back(std::this_thread::get_id());
+         return;
+      }
+      j = std::move(jobs_.front());
+      jobs_.pop();
+   }
+}
+
+inline
+size_t thread_cache::size() const
+{
+   std::lock_guard<std::mutex> l(mutex_);
+   return threads_.size() - retired_.size();
+}
+
+inline
+size_t thread_cache::idle() const
+{
+   std::lock_guard<std::mutex> l(mutex_);
+   return idle_ - std::min(idle_, jobs_.size());
+}
+
+/**
+   \brief the process-wide thread_cache, it is created by the first call
+*/
+inline
+thread_cache& default_thread_cache()
+{
+   static thread_cache the_cache;
+   return the_cache;
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_THREAD_CACHE_INCLUDED_
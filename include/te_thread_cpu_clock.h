@@ -0,0 +1,66 @@
+#ifndef _THREAD_EX_THREAD_CPU_CLOCK_INCLUDED_
+#define _THREAD_EX_THREAD_CPU_CLOCK_INCLUDED_
+
+/**
+	\file 	te_thread_cpu_clock.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <chrono>
+#ifdef _WIN32
+   #ifndef NOMINMAX
+      #define NOMINMAX
+   #endif
+   #include <windows.h>
+#else
+   #include <time.h>
+#endif
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+
+/**
+   \brief a clock of CPU time consumed by the calling thread, it meets the requirements of std::chrono 'Clock'
+
+   The difference of wall time (std::chrono::steady_clock) and CPU time of a piece of code is the time it was blocked or preempted.
+   - POSIX: clock_gettime(CLOCK_THREAD_CPUTIME_ID)
+   - Windows: GetThreadTimes (user + kernel time), the resolution is the one of the scheduler tick
+
+   \example unit/test_thread_pool.cpp
+*/
+
+namespace thread_ex
+{
+
+struct thread_cpu_clock
+{
+   using duration    = std::chrono::nanoseconds;
+   using rep         = duration::rep;
+   using period      = duration::period;
+   using time_point  = std::chrono::time_point<thread_cpu_clock>;
+   static constexpr bool is_steady = true;
+
+   static time_point now() noexcept
+   {
+#ifdef _WIN32
+      FILETIME creation, exit, kernel, user;
+      if(!::GetThreadTimes(::GetCurrentThread(), &creation, &exit, &kernel, &user))
+         return time_point{};
+      const auto ticks = [](const FILETIME& t) { return (static_cast<rep>(t.dwHighDateTime) << 32) | t.dwLowDateTime; };
+      return time_point{duration{(ticks(kernel) + ticks(user)) * 100}};   // 100-nanosecond intervals
+#else
+      timespec ts;
+      if(::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+         return time_point{};
+      return time_point{std::chrono::seconds{ts.tv_sec} + duration{ts.tv_nsec}};
+#endif
+   }
+};
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_THREAD_CPU_CLOCK_INCLUDED_
@@ -20,13 +20,31 @@
 #include <cassert>
 #include <type_traits>
 #include <tuple>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <system_error>
+#include <array>
+#include <string>
+#include <stdexcept>
 #include "te_compiler_warning_rollback.h"
 #include "te_compiler.h"
 #include "te_container.h"
+#include "te_fair_queue.h"
+#include "te_expired_error.h"
+#include "te_thread_cpu_clock.h"
 #include "te_thread_unjoinable.h"
+#include "te_thread_builder.h"
+#include "te_concurrency_governor.h"
+#include "te_observable_future.h"
 
 /**
-   \brief a thread pool is a fixed number of worker threads (typically the same number as the value returned by std::thread::hardware_concurrency()) that process work.
+   \brief a thread pool is a fixed number of worker threads (typically the same number as the value returned by available_concurrency()) that process work.
 
    On most systems, its impractical to have a separate thread for every task that can potentially be done in parallel with other tasks, 
    but there is  still need to take advantage of the available concurrency where possible. 
@@ -36,6 +54,14 @@
    Each task is then taken from the queue by one of the worker threads, 
    which executes the task before looping back to take another from the queue.
 
+   The workers of a pool governed by govern(&concurrency_governor::global()) share one budget with the other governed pools
+   (see te_concurrency_governor.h). A worker owns a governor token only while it is busy, an idle worker gives its token back
+   to the other pools. Governance is opt-in: a task waiting for another task of a governed pool keeps its token,
+   so a pool whose tasks wait for each other should not be governed (or should wait in a blocking_section).
+   Tasks which touch the same data can be routed to the same worker by 'submit_with_key' (cache locality),
+   idle workers steal the tasks queued to the busy ones.
+   The futures of the tasks are observable (see te_observable_future.h), when_all and when_any combine them (see te_when.h).
+
    \remark "C++ Concurrency in Action", Anthony Williams, chapter 9.1.2, page 277
    \example unit/test_thread_pool.cpp
 */
@@ -43,23 +69,62 @@
 namespace thread_ex
 {
 
+class thread_pool;
+
+   // the number of distinct tags of tasks (see task_options::tag), tag 0 is the one of untagged tasks
+constexpr size_t max_task_tags = 64;
+
+   // the tag of the name, the same name is the same tag in the whole process. std::length_error - all the tags are in use
+size_t         intern_tag(const std::string&);
+std::string    tag_name(size_t);
+
+/**
+   \brief optional attributes of a task submitted to thread_pool
+*/
+struct task_options
+{
+   const char*    label    {nullptr};  // reported by the watchdog (see thread_pool::watch). It must outlive the task, a string literal is fine
+   size_t         tenant   {0};        // the tenants take turns in the shared queue (see fair_queue), keyed tasks bypass it
+      // a task taken by a worker after the deadline is discarded without running, its future gets expired_error
+   std::chrono::steady_clock::time_point  deadline {std::chrono::steady_clock::time_point::max()};
+      // the feature the cost of the task is attributed to (see thread_pool::account), an interned name or a value of an enum below max_task_tags
+   size_t         tag      {0};
+};
+
 namespace tpis // thread_pool_internals
 {
+   struct tag_registry
+   {
+      std::mutex                 mutex;
+      std::vector<std::string>   names {std::string{}};
+   };
+
+   inline tag_registry& tags()
+   {
+      static tag_registry r;
+      return r;
+   }
+
+   struct tag_counters
+   {
+      std::atomic<std::uint64_t> count  {0};
+      std::atomic<std::uint64_t> wall   {0};  // nanoseconds
+      std::atomic<std::uint64_t> cpu    {0};  // nanoseconds
+   };
+
    class movable_function_body
    {
       struct void_signature
       {
-         virtual void call() = 0;
-         virtual bool exit_marker() const noexcept = 0;
+         virtual void call(bool expired) = 0;
          virtual ~void_signature() {}
       };
 
       template <typename Callable>
-         // where Callable is an instance of class template std::packaged_task<...>
+         // where Callable wraps an instance of class template std::packaged_task<...>
       struct void_signature_impl : void_signature
       {
-         bool exit_marker() const noexcept override { return false; }
-         void call() override { f_(); }
+         void call(bool expired) override { f_(expired); }
 
          explicit void_signature_impl(Callable&& f) : f_(std::move(f)) {}
          void_signature_impl& operator=(Callable&& f) { f_(std::move(f)); return *this; }
@@ -70,26 +135,16 @@ namespace tpis // thread_pool_internals
          Callable f_;
       };
 
-      struct exit_signature_impl : void_signature
-      {
-         bool exit_marker() const noexcept override { return true; }
-         void call() override {}
-      };
-
    public:
       template <typename Callable>
       using package_task_type = void_signature_impl<Callable>;
-      using exit_task_type    = exit_signature_impl;
-
-      /**
-         \retval
-            'true'  - function completed successfully. The current thread is still in active state & continuous listening incoming tasks 
-            'false' - that was the last function call. The listening thread must be terminated.
-      */
-      bool operator()() { f_->call(); return !f_->exit_marker(); }
+
+      void operator()() { f_->call(false); }
+      void discard()    { f_->call(true); }  // the future gets expired_error
+      bool expired() const { return options_.deadline!=std::chrono::steady_clock::time_point::max() && options_.deadline < std::chrono::steady_clock::now(); }
+      const task_options& options() const noexcept { return options_; }
       template <typename Function>
-      movable_function_body(Function&& f)       : f_{ new package_task_type<Function>(std::move(f)) } {}
-      movable_function_body(exit_task_type&&)   : f_{ new exit_task_type{} } {}
+      movable_function_body(Function&& f, const task_options& o) : f_{ new package_task_type<Function>(std::move(f)) }, options_(o) {}
 
          // movable only
       movable_function_body()                                         = default;
@@ -100,26 +155,130 @@ namespace tpis // thread_pool_internals
 
    private:
       std::unique_ptr<void_signature> f_;
+      task_options                    options_;
    };
+
+   template <typename T>
+   using is_task_options = std::is_same<std::decay_t<T>, task_options>;
+
+      // nobody waits on a queue itself, the workers are parked by the pool
+   using task_queue_type   = mutex_wrap<movable_function_body, std::queue<movable_function_body>>;
+   using shared_queue_type = fair_queue<movable_function_body>;
+
+   struct worker_slot
+   {
+      task_queue_type            tasks;               // the tasks routed to this worker by key
+      std::condition_variable    wake;
+      bool                       sleeping {false};    // guarded by thread_pool::park_mutex_
+         // the task in progress, stamped only while the pool is watched
+      std::atomic<std::int64_t>  started  {0};        // steady_clock ticks, 0 - no task
+      std::atomic<const char*>   label    {nullptr};
+         // owned by the worker thread, a blocking_section gives them back to the governor and to the other workers
+      concurrency_token          token;
+      task_queue_type::container_type  batch;   // taken but not started yet
+         // compensating workers only (see blocking_section), guarded by thread_pool::compensate_mutex_
+      native_thread              thread;
+      bool                       running  {false};
+         // written by the worker thread only, while the pool is accounted
+      std::array<tag_counters, max_task_tags>   usage;
+   };
+
+   struct current_worker_type
+   {
+      thread_pool*   pool;
+      size_t         worker;
+      size_t         blocking;   // depth of nested blocking sections
+   };
+
+      // the pool and the index of the worker the current thread is, {nullptr} for a thread out of pools
+   inline current_worker_type& current_worker() noexcept
+   {
+      static thread_local current_worker_type w;
+      return w;
+   }
 }  // end of 'thread_pool_internals'
 
+inline
+size_t intern_tag(const std::string& name)
+{
+   tpis::tag_registry& r = tpis::tags();
+   std::lock_guard<std::mutex> l(r.mutex);
+   const auto i = std::find(r.names.begin(), r.names.end(), name);
+   if(r.names.end()!=i)
+      return static_cast<size_t>(std::distance(r.names.begin(), i));
+   if(max_task_tags==r.names.size())
+      throw std::length_error("all the task tags are in use");
+   r.names.push_back(name);
+   return r.names.size() - 1;
+}
+
+inline
+std::string tag_name(size_t tag)
+{
+   tpis::tag_registry& r = tpis::tags();
+   std::lock_guard<std::mutex> l(r.mutex);
+   return tag < r.names.size()? r.names[tag] : std::to_string(tag);
+}
+
 /**
    The implementation below allows you be in waiting state to ensure the overall submitted task was complete before returning to the caller.
    By moving std::future-driven technique into the thread_pool itself, you can wait for the task directly.
    You can have the submit() function return a task handle of some description that you can then use to wait for the task to complete. 
    This task handle would wrap the use of condition variables or futures, thus simplifying the code that uses the thread pool.
    Any task you want to submit is 'f' - a function-delegate or object of 'Callable' concept with 'args...' arbitrary parameters to pass to 'f'.  
+
+   Every worker owns a queue of its own besides the queue shared by all the workers. 
+   The shared queue is fair between tenants (task_options::tenant): a tenant with a huge backlog does not delay the others.
+   'submit_with_key' routes all the tasks with the same key to the same worker, so they find the data of the key in the cache of that core.
+   A worker looks into its own queue first, then into the shared one and at last it steals a half of the backlog of another worker.
+   An idle worker is woken up to steal as soon as the owner of a key has a backlog, so the load stays balanced.
+
+   A task which is about to block (I/O, waiting for something) marks the blocking part by blocking_section.
+   The pool starts a compensating worker for the time of blocking, so CPU-bound tasks do not queue up.
+   A compensating worker retires as soon as the blocked one is back, their number is limited by 'compensate'.
+
+   The cost of tasks can be attributed to features sharing the pool: a task is tagged by task_options::tag,
+   while the pool is accounted ('account') the workers sum up the wall and the CPU time of the tasks per tag.
+
+   'watch' starts an optional watchdog thread. It looks at the start time of the task in progress of every worker
+   and reports (once) every task running longer than the threshold: its label (task_options), the worker index and the elapsed time.
 */
 
 class thread_pool
 {
    using movable_function_body   = tpis::movable_function_body;
-   using task_queue_type         = threadsafe_queue<movable_function_body>;
-   using thread_container_type   = std::vector<joined_thread>;
-   using exit_task_type          = typename movable_function_body::exit_task_type;
+   using task_queue_type         = tpis::task_queue_type;
+   using shared_queue_type       = tpis::shared_queue_type;
+   using task_batch_type         = typename task_queue_type::container_type;
+   using worker_slot             = tpis::worker_slot;
+   using slot_container_type     = std::vector<std::unique_ptr<worker_slot>>;
+   using thread_container_type   = std::vector<joined_native_thread>;
+   using unique_lock_type        = std::unique_lock<std::mutex>;
+   template <typename T>
+   using not_options_t           = std::enable_if_t<!tpis::is_task_options<T>::value>;
 
 public:
    const struct deferred_start_type {}    deferred_start{};
+   struct metrics_type
+   {
+      size_t   queued      {0};  // waiting for a worker
+      size_t   discarded   {0};  // expired tasks discarded without running (see task_options::deadline)
+      size_t   blocked     {0};  // workers inside blocking_section
+      size_t   compensating{0};  // compensating workers running at the moment
+   };
+   struct tag_usage
+   {
+      size_t                     tag   {0};
+      std::string                name;          // see intern_tag, the number for a tag which is not interned
+      size_t                     count {0};     // tasks completed
+      std::chrono::nanoseconds   wall  {0};
+      std::chrono::nanoseconds   cpu   {0};     // wall - cpu is the time the tasks were blocked (or preempted)
+   };
+      // label of the task, worker index, elapsed time. It is called by the watchdog thread
+   using watchdog_callback = std::function<void(const char*, size_t, std::chrono::milliseconds)>;
+
+      // the upper limit of tasks taken by a worker from the queue at once (one lock per batch)
+   static constexpr size_t max_batch = 16;
 
    thread_pool();
    explicit thread_pool(size_t);
@@ -129,28 +288,98 @@ public:
    ~thread_pool();
 
    size_t   thread_count() const noexcept;
-   void     start(size_t = std::thread::hardware_concurrency());
+   metrics_type metrics() const noexcept;
+      // starts/stops sampling the wall and the CPU time of every task, the workers sum them up per tag
+   void     account(bool) noexcept;
+      // the sums of all the workers, the tags with completed tasks only
+      // the time of a task is added up right after its future is made ready
+   std::vector<tag_usage> accounting() const;
+      // the budget the workers run under, 'nullptr' (by default) - the pool is not governed at all.
+      // must be called before 'start'
+   void     govern(concurrency_governor*) noexcept;
+      // the upper limit of compensating workers for the workers blocked in blocking_section, thread count by default. 0 - no compensation
+      // must be called before 'start'
+   void     compensate(size_t) noexcept;
+   void     start(size_t = available_concurrency());
+      // the workers are started by 'builder' (stack size, scheduling policy), the worker number 'i' is named "<name>/i"
+   void     start(size_t, const thread_builder& builder);
       // graceful completion. All pending tasks will be completed before the stop
    void     stop();
       // stop working as soon as possible. That means some tasks in the queue might be unprocessed
    void     terminate(); 
+      // the number of tasks of the tenant taken from the shared queue per turn, 1 by default
+   void     set_tenant_weight(size_t tenant, size_t weight);
+      // starts the watchdog thread, it is stopped together with the workers. Can be called once after 'start'
+   void     watch(std::chrono::milliseconds threshold, watchdog_callback);
 
    /**
       \brief 'submit' This is very similar to the way that the std::async - based.
-      \retval std::future<...> of behaviour which conforms to the return by std::packaged_task 
+      \retval observable_future<...> of behaviour which conforms to the return by std::packaged_task 
    */
-   template <typename Function, typename... Args>
-   decltype(auto) // std::futute<retval of Function>
+   template <typename Function, typename... Args, typename = not_options_t<Function>>
+   decltype(auto) // observable_future<retval of Function>
    submit(Function&&,Args&&...);
+   template <typename Function, typename... Args>
+   decltype(auto) // observable_future<retval of Function>
+   submit(const task_options&,Function&&,Args&&...);
+
+   /**
+      \brief the same as 'submit' but the task is queued to the worker selected by std::hash<Key> of 'key'
+   */
+   template <typename Key, typename Function, typename... Args, typename = not_options_t<Function>>
+   decltype(auto) // observable_future<retval of Function>
+   submit_with_key(const Key&,Function&&,Args&&...);
+   template <typename Key, typename Function, typename... Args>
+   decltype(auto) // observable_future<retval of Function>
+   submit_with_key(const Key&,const task_options&,Function&&,Args&&...);
+
+   /**
+      \brief fire-and-forget: f() is queued without std::packaged_task and future, the task is the only allocation.
+      'f' must not throw, an exception thrown by it terminates the program as it does for std::thread
+   */
+   template <typename Function>
+   void     post(Function&&);
 
 private:
-   void     listening_thread(); 
+   friend class blocking_section;
+   static constexpr size_t any_worker = static_cast<size_t>(-1);
+
+   template <typename Function, typename... Args>
+   decltype(auto) schedule(size_t,const task_options&,Function&&,Args&&...);
+   void     push(movable_function_body&&, size_t);
+   void     wake(size_t, bool);
+   size_t   take(size_t, task_batch_type&);
+   bool     park(size_t);
+   bool     retire(size_t);
+   static void accounted_call(worker_slot&, movable_function_body&);
+   void     begin_blocking(size_t);
+   void     end_blocking(size_t);
+   void     listening_thread(size_t); 
+   void     watchdog_thread(std::chrono::milliseconds, watchdog_callback);
 
 private:
    size_t                  thread_count_  {0} ;
    std::atomic_bool        done_          {false};   
-   task_queue_type         tasks_;
+   concurrency_governor*   governor_      {nullptr};
+   shared_queue_type       tasks_;                    // shared by all the workers
+   slot_container_type     slots_;                    // one per worker
+   std::atomic<size_t>     queued_        {0};        // tasks in all the queues
+   std::atomic<size_t>     sleeping_      {0};
+   std::mutex              park_mutex_;
+   std::vector<size_t>     sleepers_;                 // guarded by park_mutex_
+   bool                    stopping_      {false};    // guarded by park_mutex_
    thread_container_type   threads_;
+   thread_builder          builder_;                  // of all the workers, the compensating ones too
+   std::atomic<size_t>     discarded_     {0};        // expired tasks
+   size_t                  max_compensating_ {any_worker};
+   std::mutex              compensate_mutex_;
+   std::atomic<size_t>     blocked_       {0};        // modified under compensate_mutex_
+   std::atomic<size_t>     compensating_  {0};        // modified under compensate_mutex_
+   bool                    compensation_closed_ {false};  // guarded by compensate_mutex_
+   std::atomic_bool        accounting_    {false};
+   std::atomic_bool        watching_      {false};
+   std::condition_variable watchdog_wake_;            // guarded by park_mutex_
+   std::thread             watchdog_;
 };
 
 inline 
@@ -182,13 +411,83 @@ size_t   thread_pool::thread_count() const noexcept
    return thread_count_;
 }
 
+inline
+thread_pool::metrics_type thread_pool::metrics() const noexcept
+{
+   metrics_type m;
+   m.queued    = queued_.load(std::memory_order_relaxed);
+   m.discarded = discarded_.load(std::memory_order_relaxed);
+   m.blocked   = blocked_.load(std::memory_order_relaxed);
+   m.compensating = compensating_.load(std::memory_order_relaxed);
+   return m;
+}
+
+inline
+void thread_pool::account(bool on) noexcept
+{
+   accounting_ = on;
+}
+
+inline
+std::vector<thread_pool::tag_usage> thread_pool::accounting() const
+{
+   std::vector<tag_usage> r;
+   for(size_t tag = 0; tag < max_task_tags; ++tag)
+   {
+      tag_usage u;
+      u.tag = tag;
+      for(const auto& s : slots_)
+      {
+         const tpis::tag_counters& c = s->usage[tag];
+         u.count += static_cast<size_t>(c.count.load(std::memory_order_relaxed));
+         u.wall  += std::chrono::nanoseconds(c.wall.load(std::memory_order_relaxed));
+         u.cpu   += std::chrono::nanoseconds(c.cpu.load(std::memory_order_relaxed));
+      }
+      if(u.count)
+      {
+         u.name = tag_name(tag);
+         r.push_back(std::move(u));
+      }
+   }
+   return r;
+}
+
+inline
+void thread_pool::govern(concurrency_governor* g) noexcept
+{
+   assert(threads_.empty() && "'govern' must be called before 'start'");
+   governor_ = g;
+}
+
+inline
+void thread_pool::compensate(size_t n) noexcept
+{
+   assert(threads_.empty() && "'compensate' must be called before 'start'");
+   max_compensating_ = n;
+}
+
 inline 
 void thread_pool::start(size_t n)
+{
+   start(n, thread_builder{});
+}
+
+inline
+void thread_pool::start(size_t n, const thread_builder& builder)
 {
    assert(n && "thread count must be greater zero");
    assert(threads_.empty() && "'start' can be called once");
 
    thread_count_ = n;
+   builder_      = builder;
+   stopping_     = false;
+   compensation_closed_ = false;
+   slots_.clear();
+      // the slots of compensating workers follow the regular ones, they have no keyed tasks
+   const size_t extra = any_worker==max_compensating_? n : max_compensating_;
+   for(size_t i = 0; i < thread_count_ + extra; ++i)
+      slots_.push_back(std::make_unique<worker_slot>());
+   sleepers_.reserve(slots_.size());
 
 #ifdef _MSC_VER
    #pragma warning( push )
@@ -197,7 +496,7 @@ void thread_pool::start(size_t n)
    try
    {
       for(size_t i = 0; i < thread_count_; ++i)
-         threads_.push_back(std::thread{&thread_pool::listening_thread,this});
+         threads_.push_back(builder_.indexed(i).spawn(&thread_pool::listening_thread,this,i));
    }
    catch(...)
    {
@@ -214,9 +513,26 @@ void thread_pool::start(size_t n)
 inline
 void thread_pool::stop()
 {
-   for(size_t i=0; i<thread_count_; ++i)
-      tasks_.push(exit_task_type{});
+   {  std::lock_guard<std::mutex> l(park_mutex_);
+      stopping_ = true;
+      for(auto& s : slots_)
+         s->wake.notify_one();
+   }
    thread_container_type{}.swap(threads_); 
+
+   {  std::lock_guard<std::mutex> l(compensate_mutex_);
+      compensation_closed_ = true;
+   }
+   for(size_t i = thread_count_; i < slots_.size(); ++i)
+      if(slots_[i]->thread.joinable())
+         slots_[i]->thread.join();
+
+   {  std::lock_guard<std::mutex> l(park_mutex_);
+      watching_ = false;
+      watchdog_wake_.notify_one();
+   }
+   if(watchdog_.joinable())
+      watchdog_.join();
 }
 
 inline
@@ -227,44 +543,426 @@ void thread_pool::terminate()
 }
 
 inline
-void thread_pool::listening_thread()
+void thread_pool::set_tenant_weight(size_t tenant, size_t weight)
+{
+   tasks_.set_weight(tenant, weight);
+}
+
+inline
+void thread_pool::watch(std::chrono::milliseconds threshold, watchdog_callback f)
+{
+   assert(!threads_.empty() && "'watch' must be called after 'start'");
+   assert(!watchdog_.joinable() && "'watch' can be called once");
+   watching_ = true;
+   watchdog_ = std::thread{&thread_pool::watchdog_thread,this,threshold,std::move(f)};
+}
+
+inline
+void thread_pool::watchdog_thread(std::chrono::milliseconds threshold, watchdog_callback f)
+{
+   using clock = std::chrono::steady_clock;
+   const auto period = std::max(threshold/4, std::chrono::milliseconds(1));
+   std::vector<std::int64_t> reported(slots_.size(), 0);
+
+   unique_lock_type l(park_mutex_);
+   while(watching_)
+   {
+      watchdog_wake_.wait_for(l, period, [this] { return !watching_; });
+      l.unlock();
+      const auto now = clock::now().time_since_epoch();
+      for(size_t i = 0; i < slots_.size(); ++i)
+      {
+         worker_slot& s = *slots_[i];
+         const std::int64_t started = s.started.load(std::memory_order_acquire);
+         const char* label = s.label.load(std::memory_order_relaxed);
+         if(!started || started==reported[i] || started!=s.started.load(std::memory_order_acquire))
+            continue;
+         const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - clock::duration(started));
+         if(elapsed < threshold)
+            continue;
+         reported[i] = started;
+         f(label? label : "", i, elapsed);
+      }
+      l.lock();
+   }
+}
+
+inline
+void thread_pool::push(movable_function_body&& f, size_t worker)
+{
+   size_t backlog {0};
+   if(any_worker==worker)
+   {
+      const size_t tenant = f.options().tenant;
+      tasks_.push(tenant, std::move(f));
+   }
+   else
+   {
+      worker_slot& s = *slots_[worker];
+      s.tasks.push(std::move(f));
+      backlog = s.tasks.size();
+   }
+   ++queued_;
+   if(sleeping_.load())
+      wake(worker, backlog > 1);
+}
+
+/**
+   wakes up the owner of a keyed task if it sleeps. Otherwise the most recently parked worker (its cache is the warmest) is woken up
+   for a task of the shared queue or to steal the backlog of the owner. A single task queued to a busy owner waits for it.
+*/
+inline
+void thread_pool::wake(size_t worker, bool backlog)
+{
+   std::lock_guard<std::mutex> l(park_mutex_);
+   if(sleepers_.empty())
+      return;
+   auto i = std::prev(sleepers_.end());
+   if(any_worker!=worker)
+   {
+      const auto owner = std::find(sleepers_.begin(), sleepers_.end(), worker);
+      if(sleepers_.end()!=owner)
+         i = owner;
+      else if(!backlog)
+         return;  // the owner is busy, it gets to the task on its own
+   }
+   worker_slot& s = *slots_[*i];
+   sleepers_.erase(i);
+   --sleeping_;
+   s.sleeping = false;
+   s.wake.notify_one();
+}
+
+inline
+size_t thread_pool::take(size_t worker, task_batch_type& batch)
+{
+      // a batch is a fair share of the backlog, the other workers are not left without tasks
+   size_t n = slots_[worker]->tasks.pop(std::nothrow,batch,max_batch);
+   if(!n)
+      n = tasks_.pop(std::nothrow,batch,max_batch,thread_count_);
+   for(size_t i = 1; !n && i <= thread_count_; ++i)
+   {
+      const size_t victim = (worker+i)%thread_count_;
+      if(victim!=worker)
+         n = slots_[victim]->tasks.pop(std::nothrow,batch,max_batch,2);
+   }
+   if(n)
+      queued_ -= n;
+   return n;
+}
+
+/**
+   \retval 'false' - the pool is stopping and there is nothing left to do, the worker must exit
+*/
+inline
+bool thread_pool::park(size_t worker)
 {
-   while(!done_)
+   worker_slot& self = *slots_[worker];
+   unique_lock_type l(park_mutex_);
+   if(done_ || (stopping_ && !queued_.load()))
+      return false;
+
+   self.sleeping = true;
+   sleepers_.push_back(worker);
+   ++sleeping_;
+   if(!queued_.load())  // a task pushed before 'sleeping_' is seen by the submitter is not lost
+      self.wake.wait(l, [this,&self,worker] { return !self.sleeping || stopping_ || done_ || (worker >= thread_count_ && compensating_ > blocked_); });
+   if(self.sleeping)
    {
-      movable_function_body f;
-      tasks_.wait_pop(f);
-      if(!f())
-         break;   
+      sleepers_.erase(std::find(sleepers_.begin(), sleepers_.end(), worker));
+      --sleeping_;
+      self.sleeping = false;
    }
+   return true;
+}
+
+inline
+void thread_pool::listening_thread(size_t worker)
+{
+   worker_slot&         self  = *slots_[worker];
+   task_batch_type&     batch = self.batch;
+   concurrency_token&   token = self.token;
+   tpis::current_worker() = {this, worker, 0};
+
+   bool retired {false};
+   while(!done_ && !(retired = retire(worker)))
+   {
+      if(!take(worker,batch))
+      {
+         token.release();  // the worker is going to be idle, its share of the governor is free for the others
+         if(!park(worker))
+            break;
+         continue;
+      }
+      while(!batch.empty() && !done_)
+      {
+         movable_function_body f {std::move(batch.front())};
+         batch.pop();
+         if(f.expired())
+         {
+            f.discard();
+            ++discarded_;
+            continue;
+         }
+
+         if(governor_ && !token.owns_token())
+            token = concurrency_token{*governor_};
+         else if(governor_)
+            governor_->yield();
+
+         const bool watched = watching_.load(std::memory_order_relaxed);
+         if(watched)
+         {
+            self.label.store(f.options().label, std::memory_order_relaxed);
+            self.started.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_release);
+         }
+         if(accounting_.load(std::memory_order_relaxed))
+            accounted_call(self, f);
+         else
+            f();
+         if(watched)
+            self.started.store(0, std::memory_order_release);
+      }
+   }
+
+   token.release();
+   if(!retired && worker >= thread_count_)
+   {
+      std::lock_guard<std::mutex> l(compensate_mutex_);
+      if(self.running)
+      {
+         self.running = false;
+         --compensating_;
+      }
+   }
+   tpis::current_worker() = {nullptr, 0, 0};
 } 
 
+inline
+void thread_pool::accounted_call(worker_slot& self, movable_function_body& f)
+{
+   using namespace std::chrono;
+   const size_t tag = f.options().tag;
+   assert(tag < max_task_tags && "see intern_tag");
+   tpis::tag_counters& c = self.usage[tag < max_task_tags? tag : 0];
+
+   const auto wall = steady_clock::now();
+   const auto cpu  = thread_cpu_clock::now();
+   f();
+   const auto cpu_spent  = duration_cast<nanoseconds>(thread_cpu_clock::now() - cpu);
+   const auto wall_spent = duration_cast<nanoseconds>(steady_clock::now() - wall);
+
+      // the only writer is the worker, no read-modify-write is needed
+   c.count.store(c.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+   c.wall.store(c.wall.load(std::memory_order_relaxed) + static_cast<std::uint64_t>(wall_spent.count()), std::memory_order_relaxed);
+   c.cpu.store(c.cpu.load(std::memory_order_relaxed) + static_cast<std::uint64_t>(cpu_spent.count()), std::memory_order_relaxed);
+}
+
+/**
+   \retval 'true' - the worker is a compensating one and it is not needed any longer, the blocked worker is back
+*/
+inline
+bool thread_pool::retire(size_t worker)
+{
+   if(worker < thread_count_)
+      return false;
+   std::lock_guard<std::mutex> l(compensate_mutex_);
+   if(compensating_ <= blocked_)
+      return false;
+   slots_[worker]->running = false;
+   --compensating_;
+   return true;
+}
+
+inline
+void thread_pool::begin_blocking(size_t worker)
+{
+   worker_slot& self = *slots_[worker];
+   self.token.release();  // the governor may let another thread run while this one is blocked
+   if(!self.batch.empty())
+   {  // the rest of the batch is handed over, the local queue of a regular worker can be stolen from
+      queued_ += self.batch.size();
+      for(; !self.batch.empty(); self.batch.pop())
+         if(worker < thread_count_)
+            self.tasks.push(std::move(self.batch.front()));
+         else
+         {
+            const size_t tenant = self.batch.front().options().tenant;
+            tasks_.push(tenant, std::move(self.batch.front()));
+         }
+      if(sleeping_.load())
+         wake(any_worker, true);
+   }
+
+   std::lock_guard<std::mutex> l(compensate_mutex_);
+   ++blocked_;
+   if(compensating_ >= blocked_ || compensation_closed_)
+      return;
+   for(size_t i = thread_count_; i < slots_.size(); ++i)
+   {
+      worker_slot& s = *slots_[i];
+      if(s.running)
+         continue;
+      if(s.thread.joinable())
+         s.thread.join();   // a retired one, it has already left the loop
+      try
+      {
+         s.thread = builder_.indexed(i).spawn(&thread_pool::listening_thread,this,i);
+         s.running = true;
+         ++compensating_;
+      }
+      catch(const std::system_error&)
+      {  // no compensation, the pool goes on with the workers it has
+      }
+      return;
+   }
+}
+
+inline
+void thread_pool::end_blocking(size_t worker)
+{
+   bool surplus {false};
+   {  std::lock_guard<std::mutex> l(compensate_mutex_);
+      --blocked_;
+      surplus = compensating_ > blocked_;
+   }
+   if(surplus)
+   {  // a sleeping compensating worker is woken up to retire
+      std::lock_guard<std::mutex> l(park_mutex_);
+      for(size_t i = thread_count_; i < slots_.size(); ++i)
+         slots_[i]->wake.notify_one();
+   }
+      // the rest of the task runs within the budget again, the worker waits for a token as it does before a task.
+      // The compensating worker gives its token back at the end of its current task at the latest
+   if(governor_)
+      slots_[worker]->token = concurrency_token{*governor_};
+}
+
 template <typename Function, typename... Args>
 inline
 decltype(auto)
-thread_pool::submit(Function&& f,Args&&... args)
+thread_pool::schedule(size_t worker, const task_options& options, Function&& f,Args&&... args)
 {
    using result_type = std::result_of_t<std::decay_t<Function>(std::decay_t<Args>...)>;
 
-   std::packaged_task<result_type(std::decay_t<Args>...)> pack {std::forward<Function>(f)};
-   auto future = pack.get_future(); 
+      // the leading flag of the task says the deadline is expired, std::ref(f)(...) is INVOKE (pointers to members are supported)
+   std::packaged_task<result_type(bool,std::decay_t<Args>...)> pack {
+      [f=std::decay_t<Function>{std::forward<Function>(f)}](bool expired, std::decay_t<Args>&&... a) mutable -> result_type {
+         if(expired)
+            throw expired_error();
+         return std::ref(f)(std::move(a)...);
+      }
+   };
+   auto cell = std::make_shared<ofis::completion_cell>();
+   observable_future<result_type> future {pack.get_future(),cell};
 
 #ifdef _MSC_VER
    #pragma warning( push )
    #pragma warning( disable: 4625 ) // '<lambda_...>': copy constructor was implicitly defined as deleted
 #endif
 
-   auto lambda = [p=std::move(pack),a=std::make_tuple(std::forward<Args>(args)...)]() mutable { 
-      apply(std::move(p),std::move(a)); 
+   auto lambda = [p=std::move(pack),a=std::make_tuple(std::forward<Args>(args)...)](bool expired) mutable { 
+      thread_ex::apply([&p,expired](auto&&... x) { p(expired,std::forward<decltype(x)>(x)...); },std::move(a)); 
    };
 
 #ifdef _MSC_VER
    #pragma warning( pop )
 #endif
 
-   tasks_.push(std::move(lambda));
+   push(movable_function_body{ofis::notifying<decltype(lambda)>{std::move(cell),std::move(lambda)},options},worker);
    return future;
 }
 
+template <typename Function, typename... Args, typename>
+inline
+decltype(auto)
+thread_pool::submit(Function&& f,Args&&... args)
+{
+   return schedule(any_worker,task_options{},std::forward<Function>(f),std::forward<Args>(args)...);
+}
+
+template <typename Function, typename... Args>
+inline
+decltype(auto)
+thread_pool::submit(const task_options& options, Function&& f,Args&&... args)
+{
+   return schedule(any_worker,options,std::forward<Function>(f),std::forward<Args>(args)...);
+}
+
+template <typename Key, typename Function, typename... Args, typename>
+inline
+decltype(auto)
+thread_pool::submit_with_key(const Key& key, Function&& f,Args&&... args)
+{
+   return submit_with_key(key,task_options{},std::forward<Function>(f),std::forward<Args>(args)...);
+}
+
+template <typename Key, typename Function, typename... Args>
+inline
+decltype(auto)
+thread_pool::submit_with_key(const Key& key, const task_options& options, Function&& f,Args&&... args)
+{
+   const size_t worker = thread_count_? std::hash<Key>{}(key) % thread_count_ : any_worker;
+   return schedule(worker,options,std::forward<Function>(f),std::forward<Args>(args)...);
+}
+
+template <typename Function>
+inline
+void thread_pool::post(Function&& f)
+{
+   auto lambda = [f=std::decay_t<Function>{std::forward<Function>(f)}](bool expired) mutable noexcept {
+      if(!expired)
+         f();
+   };
+   push(movable_function_body{std::move(lambda),task_options{}},any_worker);
+}
+
+
+/**
+   \brief the process-wide thread_pool of available_concurrency() workers, it is started by the first call
+*/
+inline
+thread_pool& default_thread_pool()
+{
+   static thread_pool the_pool;
+   return the_pool;
+}
+
+/**
+   \brief RAII marker of a part of a thread_pool task which is about to block (file reads, waiting for a reply and so on)
+
+   The pool is told the current worker does not use CPU for a while, its governor token is given back
+   (and taken again when the section is left)
+   and a compensating worker is started (up to the limit set by thread_pool::compensate) to run the queued tasks meanwhile.
+   Nested sections are counted once. Out of a thread_pool worker it does nothing.
+   \remark java.util.concurrent.ForkJoinPool.ManagedBlocker
+*/
+class blocking_section
+{
+public:
+   blocking_section()
+   {
+      tpis::current_worker_type& w = tpis::current_worker();
+      if(w.pool && 0==w.blocking++)
+      {
+         pool_ = w.pool;
+         pool_->begin_blocking(w.worker);
+      }
+   }
+   ~blocking_section()
+   {
+      tpis::current_worker_type& w = tpis::current_worker();
+      if(w.pool)
+         --w.blocking;
+      if(pool_)
+         pool_->end_blocking(w.worker);
+   }
+   blocking_section(const blocking_section&)             = delete;
+   blocking_section& operator=(const blocking_section&)  = delete;
+
+private:
+   thread_pool* pool_ {nullptr};
+};
 
 } // namespace thread_ex
 
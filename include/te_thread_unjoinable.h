@@ -1,8 +1,8 @@
-#ifndef _THREAD_EX_RUNTIME_CONCURRENCY_INCLUDED_
-#define _THREAD_EX_RUNTIME_CONCURRENCY_INCLUDED_
+#ifndef _THREAD_EX_THREAD_UNJOINABLE_INCLUDED_
+#define _THREAD_EX_THREAD_UNJOINABLE_INCLUDED_
 
 /**
-	\file 		te_runtime_concurrency.h
+	\file 		te_thread_unjoinable.h
 	\brief  	some usefull thread primitives (extensions) which are not included into std (since C++11) 
 	\author 	Alexander Nikolayenko
 	\date		2012-02-10
@@ -12,8 +12,10 @@
 #include "te_compiler_warning_suppress.h"
 #include <thread>
 #include <utility>
+#include <type_traits>
 #include "te_compiler_warning_rollback.h"
 #include "te_compiler.h"
+#include "te_stop_token.h"
 
 
 
@@ -43,21 +45,31 @@ namespace details_
 {
    struct join_policy
    {
-      void operator()(std::thread& t) { t.join(); }
+      template <typename THREAD_T>
+      void operator()(THREAD_T& t) { t.join(); }
    };
    struct detach_policy
    {
-      void operator()(std::thread& t) { t.detach(); }
+      template <typename THREAD_T>
+      void operator()(THREAD_T& t) { t.detach(); }
    };
+
+   template <typename Function, typename Args, typename = void>
+   struct takes_stop_token : std::false_type {};
+
+   template <typename Function, typename... Args>
+   struct takes_stop_token<Function, void(Args...), decltype(void(std::declval<std::decay_t<Function>>()(std::declval<stop_token>(), std::declval<std::decay_t<Args>>()...)))>
+      : std::true_type {};
 }  // details_
 
-template < typename POLICY >
+   // THREAD_T is std::thread or a thread of the same interface (native_thread of te_thread_builder.h)
+template < typename POLICY, typename THREAD_T = std::thread >
 class thread_unjoinable
 {
-   std::thread thread_;
+   THREAD_T thread_;
 
 public:
-   thread_unjoinable(std::thread&& t) : thread_(std::move(t)) {}
+   thread_unjoinable(THREAD_T&& t) : thread_(std::move(t)) {}
    thread_unjoinable(thread_unjoinable&&)                   = default;
    thread_unjoinable& operator=(thread_unjoinable&&)        = default;
    thread_unjoinable(const thread_unjoinable&)              = delete;
@@ -68,13 +80,92 @@ public:
       if(thread_.joinable())
          POLICY()(thread_);
    }
-   std::thread& get() { return thread_; }
+   THREAD_T& get() { return thread_; }
 };
 
 using joined_thread     = thread_unjoinable<details_::join_policy>;
 using detached_thread   = thread_unjoinable<details_::detach_policy>;
 
+   /**
+   \brief joined_thread which owns a stop_source, the stop is requested before the join
+   \remark http://en.cppreference.com/w/cpp/thread/jthread
+
+   The function gets the stop_token of the thread as the first argument if it takes one,
+   a wait of the thread interrupted by the token (see threadsafe_queue::wait_pop) lets the destructor join it promptly.
+   */
+class stoppable_thread
+{
+   stop_source    source_;   // the first one, the thread gets its token
+   std::thread    thread_;
+
+public:
+   stoppable_thread() noexcept : source_(nostopstate)     {}   // no thread, no stop state
+   template <typename Function, typename... Args, typename = std::enable_if_t<!std::is_same<std::decay_t<Function>, stoppable_thread>::value>>
+   explicit stoppable_thread(Function&& f, Args&&... args);
+   stoppable_thread(stoppable_thread&&) noexcept          = default;
+   stoppable_thread& operator=(stoppable_thread&&);
+   stoppable_thread(const stoppable_thread&)              = delete;
+   stoppable_thread& operator=(const stoppable_thread&)   = delete;
+   ~stoppable_thread()                                    { stop(); }
+
+   bool           joinable() const noexcept     { return thread_.joinable(); }
+   void           join()                        { thread_.join(); }
+   std::thread&   get()                         { return thread_; }
+   bool           request_stop()                { return source_.request_stop(); }
+   stop_source    get_stop_source() const       { return source_; }
+   stop_token     get_stop_token() const noexcept  { return source_.get_token(); }
+
+private:
+   template <typename Function, typename... Args>
+   static std::thread   launch(std::true_type, stop_token, Function&&, Args&&...);
+   template <typename Function, typename... Args>
+   static std::thread   launch(std::false_type, stop_token, Function&&, Args&&...);
+   void                 stop();
+};
+
+template <typename Function, typename... Args, typename>
+inline
+stoppable_thread::stoppable_thread(Function&& f, Args&&... args)
+   : thread_(launch(details_::takes_stop_token<Function, void(Args...)>{}, source_.get_token(), std::forward<Function>(f), std::forward<Args>(args)...))
+{
+}
+
+inline
+stoppable_thread& stoppable_thread::operator=(stoppable_thread&& other)
+{
+   if(this != &other)
+   {
+      stop();
+      thread_ = std::move(other.thread_);
+      source_ = std::move(other.source_);
+   }
+   return *this;
+}
+
+template <typename Function, typename... Args>
+inline
+std::thread stoppable_thread::launch(std::true_type, stop_token token, Function&& f, Args&&... args)
+{
+   return std::thread{std::forward<Function>(f), std::move(token), std::forward<Args>(args)...};
+}
+
+template <typename Function, typename... Args>
+inline
+std::thread stoppable_thread::launch(std::false_type, stop_token, Function&& f, Args&&... args)
+{
+   return std::thread{std::forward<Function>(f), std::forward<Args>(args)...};
+}
+
+inline
+void stoppable_thread::stop()
+{
+   if(!thread_.joinable())
+      return;
+   source_.request_stop();
+   thread_.join();
+}
+
 } // namespace thread_ex
 
-#endif //_THREAD_EX_RUNTIME_CONCURRENCY_INCLUDED_
+#endif //_THREAD_EX_THREAD_UNJOINABLE_INCLUDED_
 
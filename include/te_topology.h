@@ -0,0 +1,270 @@
+#ifndef _THREAD_EX_TOPOLOGY_INCLUDED_
+#define _THREAD_EX_TOPOLOGY_INCLUDED_
+
+/**
+	\file 	te_topology.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <vector>
+#include <string>
+#include <thread>
+#include <cstdlib>
+#include <tuple>
+#include <algorithm>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_available_concurrency.h"
+
+/**
+   \brief the CPU topology of the machine: which logical CPUs share a core, a cache and a NUMA node
+
+   runtime_concurrency gives one number, data partitioned by it ignores that two halves of a machine may not share
+   the last level cache or the memory controller. cpu_topology is a tree read from sysfs (Linux)
+   - packages (sockets), /sys/devices/system/cpu/cpuN/topology/physical_package_id
+   - NUMA nodes of a package, /sys/devices/system/node/nodeN/cpulist
+   - last level cache domains of a node (L3 on most x86, L2 on some ARM), /sys/devices/system/cpu/cpuN/cache/indexK
+   - cores of a cache domain, topology/core_id
+   - logical CPUs (SMT siblings) of a core
+   Every level lists its logical CPUs (the online ones, not only those of the affinity mask), ascending.
+   A cache shared by several NUMA nodes (sub-NUMA clustering) is a domain of every one of them, with the same CPUs of 'shared'.
+   caches() is the flat list of all the caches (L1d, L1i, L2, L3 ...), cpu_groups(level) are the CPUs sharing a cache of 'level'.
+   The root of sysfs is a parameter, so any machine can be described by a directory.
+   Without sysfs (not Linux) the topology is flat: one package, node and domain, a core per std::thread::hardware_concurrency().
+
+   \remark https://www.kernel.org/doc/Documentation/ABI/stable/sysfs-devices-system-cpu
+   \remark https://www.open-mpi.org/projects/hwloc/
+   \example unit/test_topology.cpp
+*/
+
+namespace thread_ex
+{
+
+namespace tois // topology_internals
+{
+      // a number of a file, 'otherwise' if there is no file or it is not a number (-1 of physical_package_id)
+   inline size_t number_of(const std::string& path, size_t otherwise)
+   {
+      const std::string line = cdis::read_line(path);
+      if(line.empty() || line.find_first_not_of("0123456789")!=std::string::npos)
+         return otherwise;
+      return static_cast<size_t>(std::strtoull(line.c_str(), nullptr, 10));
+   }
+
+      // "32K" -> 32768, "8M" -> 8388608
+   inline size_t cache_size(const std::string& text)
+   {
+      char* end {nullptr};
+      const size_t size = static_cast<size_t>(std::strtoull(text.c_str(), &end, 10));
+      if(end && ('K'==*end || 'k'==*end))
+         return size << 10;
+      if(end && ('M'==*end || 'm'==*end))
+         return size << 20;
+      if(end && ('G'==*end || 'g'==*end))
+         return size << 30;
+      return size;
+   }
+
+      // a node of the tree by 'id', appended if there is none
+   template <typename Node>
+   Node& child(std::vector<Node>& children, size_t id)
+   {
+      const auto i = std::find_if(children.begin(), children.end(), [id](const Node& n) { return n.id==id; });
+      if(i!=children.end())
+         return *i;
+      children.emplace_back();
+      children.back().id = id;
+      return children.back();
+   }
+}  // end of 'topology_internals'
+
+class cpu_topology
+{
+public:
+   struct core
+   {
+      size_t               id {0};     // topology/core_id, unique within a package
+      std::vector<size_t>  cpus;       // SMT siblings
+   };
+   struct cache_domain
+   {
+      size_t               id {0};     // the first CPU sharing the cache
+      size_t               level {0};  // 0 - there is no information about caches
+      size_t               size {0};   // bytes
+      std::vector<size_t>  shared;     // all the CPUs sharing the cache, of any node
+      std::vector<size_t>  cpus;       // of the node
+      std::vector<core>    cores;
+   };
+   struct numa_node
+   {
+      size_t                     id {0};
+      std::vector<size_t>        cpus;
+      std::vector<cache_domain>  domains;
+   };
+   struct package
+   {
+      size_t                  id {0};
+      std::vector<size_t>     cpus;
+      std::vector<numa_node>  nodes;
+   };
+   struct cache
+   {
+      size_t               level {0};
+      std::string          type;       // "Data", "Instruction" or "Unified"
+      size_t               size {0};   // bytes
+      std::vector<size_t>  cpus;
+   };
+
+      // 'sysfs_root' - the directory of 'devices/system/cpu' and 'devices/system/node'
+   explicit cpu_topology(const std::string& sysfs_root = "/sys");
+
+      // the topology of this machine, read by the first call
+   static const cpu_topology& system();
+
+   const std::vector<package>&   packages() const noexcept  { return packages_; }
+   const std::vector<cache>&     caches() const noexcept    { return caches_; }
+      // the groups of CPUs sharing a unified or data cache of 'level', e.g. 2 - the CPUs of every L2
+   std::vector<std::vector<size_t>> cpu_groups(size_t level) const;
+
+   bool     discovered() const noexcept   { return discovered_; }   // false - sysfs is not available, the topology is flat
+   size_t   cpu_count() const noexcept    { return cpu_count_; }
+   size_t   core_count() const noexcept   { return core_count_; }
+   size_t   node_count() const noexcept   { return node_count_; }
+   size_t   domain_count() const noexcept { return domain_count_; }
+
+private:
+   void add(size_t cpu, size_t package_id, size_t node_id, const cache& last_level, size_t core_id);
+   void count();
+
+   std::vector<package> packages_;
+   std::vector<cache>   caches_;
+   bool                 discovered_    {false};
+   size_t               cpu_count_     {0};
+   size_t               core_count_    {0};
+   size_t               node_count_    {0};
+   size_t               domain_count_  {0};
+};
+
+inline
+cpu_topology::cpu_topology(const std::string& sysfs_root)
+{
+   const std::string cpu_dir = sysfs_root + "/devices/system/cpu";
+   const std::string node_dir = sysfs_root + "/devices/system/node";
+   const std::vector<size_t> cpus = cdis::parse_cpu_list(cdis::read_line(cpu_dir + "/online"));
+   discovered_ = !cpus.empty();
+   if(!discovered_)
+   {
+      for(size_t cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu)
+         add(cpu, 0, 0, cache{}, cpu);
+      count();
+      return;
+   }
+
+   std::vector<size_t> node_of(*std::max_element(cpus.begin(), cpus.end()) + 1, 0);
+   for(size_t node : cdis::parse_cpu_list(cdis::read_line(node_dir + "/online")))
+      for(size_t cpu : cdis::parse_cpu_list(cdis::read_line(node_dir + "/node" + std::to_string(node) + "/cpulist")))
+         if(cpu < node_of.size())
+            node_of[cpu] = node;
+
+   for(size_t cpu : cpus)
+   {
+      const std::string dir = cpu_dir + "/cpu" + std::to_string(cpu);
+      cache last_level;
+      for(size_t index = 0; ; ++index)
+      {
+         const std::string cache_dir = dir + "/cache/index" + std::to_string(index);
+         cache c;
+         c.level = tois::number_of(cache_dir + "/level", 0);
+         if(0==c.level)
+            break;
+         c.type = cdis::read_line(cache_dir + "/type");
+         c.size = tois::cache_size(cdis::read_line(cache_dir + "/size"));
+         c.cpus = cdis::parse_cpu_list(cdis::read_line(cache_dir + "/shared_cpu_list"));
+         if(c.cpus.empty())
+            c.cpus.push_back(cpu);
+         if("Instruction"!=c.type && c.level > last_level.level)
+            last_level = c;
+         const auto same = [&c](const cache& other) { return other.level==c.level && other.type==c.type && other.cpus==c.cpus; };
+         if(std::none_of(caches_.begin(), caches_.end(), same))
+            caches_.push_back(std::move(c));
+      }
+      const size_t package_id = tois::number_of(dir + "/topology/physical_package_id", 0);
+      add(cpu, package_id, node_of[cpu], last_level, tois::number_of(dir + "/topology/core_id", cpu));
+   }
+   std::sort(caches_.begin(), caches_.end(), [](const cache& l, const cache& r) {
+      return std::tie(l.level, l.cpus, l.type) < std::tie(r.level, r.cpus, r.type);
+   });
+   count();
+}
+
+inline
+void cpu_topology::add(size_t cpu, size_t package_id, size_t node_id, const cache& last_level, size_t core_id)
+{
+   package& p = tois::child(packages_, package_id);
+   numa_node& n = tois::child(p.nodes, node_id);
+      // the domain of the node, the whole node if there is no information about caches
+   const size_t domain_id = last_level.cpus.empty()? node_id : last_level.cpus.front();
+   const bool new_domain = std::none_of(n.domains.begin(), n.domains.end(), [domain_id](const cache_domain& d) { return d.id==domain_id; });
+   cache_domain& d = tois::child(n.domains, domain_id);
+   if(new_domain)
+   {
+      d.level = last_level.level;
+      d.size = last_level.size;
+      d.shared = last_level.cpus;
+   }
+   core& c = tois::child(d.cores, core_id);
+
+   p.cpus.push_back(cpu);
+   n.cpus.push_back(cpu);
+   d.cpus.push_back(cpu);
+   c.cpus.push_back(cpu);
+}
+
+inline
+void cpu_topology::count()
+{
+   std::vector<size_t> nodes, domains;
+   for(const auto& p : packages_)
+   {
+      cpu_count_ += p.cpus.size();
+      for(const auto& n : p.nodes)
+      {
+         nodes.push_back(n.id);
+         for(const auto& d : n.domains)
+         {
+            domains.push_back(d.id);
+            core_count_ += d.cores.size();
+         }
+      }
+   }
+   std::sort(nodes.begin(), nodes.end());
+   std::sort(domains.begin(), domains.end());
+   node_count_ = static_cast<size_t>(std::unique(nodes.begin(), nodes.end()) - nodes.begin());
+   domain_count_ = static_cast<size_t>(std::unique(domains.begin(), domains.end()) - domains.begin());
+}
+
+inline
+std::vector<std::vector<size_t>> cpu_topology::cpu_groups(size_t level) const
+{
+   std::vector<std::vector<size_t>> groups;
+   for(const auto& c : caches_)
+      if(level==c.level && "Instruction"!=c.type)
+         groups.push_back(c.cpus);
+   return groups;
+}
+
+inline
+const cpu_topology& cpu_topology::system()
+{
+   static const cpu_topology the_topology;
+   return the_topology;
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_TOPOLOGY_INCLUDED_
@@ -0,0 +1,326 @@
+#ifndef _THREAD_EX_TYPED_THREAD_POOL_INCLUDED_
+#define _THREAD_EX_TYPED_THREAD_POOL_INCLUDED_
+
+/**
+	\file 	te_typed_thread_pool.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <vector>
+#include <memory>
+#include <type_traits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <iterator>
+#include <algorithm>
+#include <cassert>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_thread_unjoinable.h"
+#include "te_concurrency_governor.h"
+
+/**
+   \brief a thread pool for a homogeneous workload, millions of tasks of one type processed by one function
+
+   thread_pool accepts any callable with any arguments, the price is a type erasure (a virtual call and a heap allocation),
+   std::packaged_task and std::future per every task. When all the tasks are of the same type, e.g. records to process by 'process(record&)',
+   the type erasure is pure overhead. typed_thread_pool knows both the task type and the function at compile time:
+   - the pending tasks are plain TASK_T values stored contiguously in a std::vector, no allocation per task
+   - the workers take the tasks in small batches (one lock per batch) and call the function directly, it can be inlined
+     when FUNCTION_T is the type of a functor or a lambda. The default one is a pointer to function, an indirect call which is not inlined:
+     make_typed_thread_pool<TASK_T>(f) deduces FUNCTION_T from 'f'
+   - the exit signal is kept out of band (a flag), no sentinel values in the queue
+   - there are no futures, wait() blocks until every submitted task is processed and rethrows the first exception thrown by the function
+   - the workers run under the concurrency_governor given to the constructor, none by default
+
+   The function is called concurrently by all the workers, it must be safe to be called so.
+
+   \example unit/test_typed_thread_pool.cpp
+*/
+
+namespace thread_ex
+{
+
+template
+<
+    typename TASK_T
+   ,typename FUNCTION_T = void(*)(TASK_T&)
+>
+class typed_thread_pool
+{
+   using this_type               = typed_thread_pool<TASK_T, FUNCTION_T>;
+   using task_container_type     = std::vector<TASK_T>;
+   using thread_container_type   = std::vector<joined_thread>;
+   using unique_lock_type        = std::unique_lock<std::mutex>;
+
+public:
+   using task_type      = TASK_T;
+   using function_type  = FUNCTION_T;
+
+      // the upper limit of tasks taken by a worker at once
+   static constexpr size_t max_batch = 64;
+
+   explicit typed_thread_pool(function_type, size_t = available_concurrency(), concurrency_governor* = nullptr);
+   typed_thread_pool(const this_type&)              = delete;
+   this_type& operator=(const this_type&)           = delete;
+   ~typed_thread_pool();
+
+   size_t   thread_count() const noexcept;
+
+   void     submit(task_type&&);
+   void     submit(const task_type&);
+      // all the tasks in range [first,last) are submitted under the single lock
+   template <typename InputIt>
+   void     submit(InputIt first, InputIt last);
+
+      // waits until all the tasks submitted so far are processed
+      // if the function has thrown, the first exception is rethrown (once)
+   void     wait();
+      // graceful completion. All pending tasks will be completed before the stop
+   void     stop();
+      // stop working as soon as possible. That means some tasks in the queue might be unprocessed
+   void     terminate();
+
+private:
+   void     listening_thread();
+   void     notify_submitted(size_t);
+
+private:
+   function_type           function_;
+   size_t                  thread_count_  {0};
+   concurrency_governor*   governor_;
+   std::mutex              mutex_;
+   std::condition_variable has_work_;
+   std::condition_variable all_done_;
+   task_container_type     tasks_;
+   size_t                  head_          {0};     // tasks_[0, head_) are taken by the workers
+   size_t                  unfinished_    {0};     // submitted but not processed yet
+   bool                    stopping_      {false};
+   bool                    done_          {false};
+   std::exception_ptr      error_;
+   thread_container_type   threads_;
+};
+
+template <typename T, typename F>
+inline
+typed_thread_pool<T,F>::typed_thread_pool(function_type f, size_t n, concurrency_governor* g)
+   : function_(std::move(f))
+   , governor_(g)
+{
+   assert(n && "thread count must be greater zero");
+   thread_count_ = n;
+#ifdef _MSC_VER
+   #pragma warning( push )
+   #pragma warning( disable: 4571 ) // Informational: catch(...) semantics changed since Visual C++ 7.1; structured exceptions (SEH) are no longer caught
+#endif
+   try
+   {
+      for(size_t i = 0; i < n; ++i)
+         threads_.push_back(std::thread{&this_type::listening_thread,this});
+   }
+   catch(...)
+   {
+      terminate();
+      throw;
+   }
+#ifdef _MSC_VER
+   #pragma warning( pop )
+#endif
+}
+
+template <typename T, typename F>
+inline
+typed_thread_pool<T,F>::~typed_thread_pool()
+{
+   stop();
+}
+
+template <typename T, typename F>
+inline
+size_t typed_thread_pool<T,F>::thread_count() const noexcept
+{
+   return thread_count_;
+}
+
+template <typename T, typename F>
+inline
+void typed_thread_pool<T,F>::notify_submitted(size_t n)
+{
+   if(1==n)
+      has_work_.notify_one();
+   else if(n)
+      has_work_.notify_all();
+}
+
+template <typename T, typename F>
+inline
+void typed_thread_pool<T,F>::submit(task_type&& t)
+{
+   {  std::lock_guard<std::mutex> l(mutex_);
+      tasks_.push_back(std::move(t));
+      ++unfinished_;
+   }
+   notify_submitted(1);
+}
+
+template <typename T, typename F>
+inline
+void typed_thread_pool<T,F>::submit(const task_type& t)
+{
+   {  std::lock_guard<std::mutex> l(mutex_);
+      tasks_.push_back(t);
+      ++unfinished_;
+   }
+   notify_submitted(1);
+}
+
+template <typename T, typename F>
+template <typename InputIt>
+inline
+void typed_thread_pool<T,F>::submit(InputIt first, InputIt last)
+{
+   size_t n {0};
+   {  std::lock_guard<std::mutex> l(mutex_);
+      const size_t before = tasks_.size();
+      tasks_.insert(tasks_.end(), first, last);
+      n = tasks_.size() - before;
+      unfinished_ += n;
+   }
+   notify_submitted(n);
+}
+
+template <typename T, typename F>
+inline
+void typed_thread_pool<T,F>::wait()
+{
+   unique_lock_type l(mutex_);
+   all_done_.wait(l, [this] { return 0==unfinished_ || done_; });
+   if(error_)
+   {
+      std::exception_ptr e;
+      e.swap(error_);
+      std::rethrow_exception(e);
+   }
+}
+
+template <typename T, typename F>
+inline
+void typed_thread_pool<T,F>::stop()
+{
+   {  std::lock_guard<std::mutex> l(mutex_);
+      stopping_ = true;
+   }
+   has_work_.notify_all();
+   thread_container_type{}.swap(threads_);
+}
+
+template <typename T, typename F>
+inline
+void typed_thread_pool<T,F>::terminate()
+{
+   {  std::lock_guard<std::mutex> l(mutex_);
+      done_ = true;
+   }
+   all_done_.notify_all();
+   stop();
+}
+
+template <typename T, typename F>
+inline
+void typed_thread_pool<T,F>::listening_thread()
+{
+   concurrency_token    token;
+   task_container_type  batch;   // the capacity is reused from batch to batch
+
+   for(;;)
+   {
+      {  unique_lock_type l(mutex_);
+         if(head_==tasks_.size() && !stopping_ && !done_)
+         {
+            l.unlock();
+            token.release();  // the worker is going to be idle, its share of the governor is free for the others
+            l.lock();
+            has_work_.wait(l, [this] { return head_!=tasks_.size() || stopping_ || done_; });
+         }
+         if(done_ || head_==tasks_.size())
+            return;
+
+            // a fair share of the backlog, so the other workers are not left without work
+         const size_t pending = tasks_.size() - head_;
+         const size_t n = std::min(size_t{max_batch}, (pending + thread_count_ - 1) / thread_count_);
+         const auto   from = std::next(tasks_.begin(), static_cast<std::ptrdiff_t>(head_));
+         std::move(from, std::next(from, static_cast<std::ptrdiff_t>(n)), std::back_inserter(batch));
+         head_ += n;
+         if(head_==tasks_.size())
+         {
+            tasks_.clear();
+            head_ = 0;
+         }
+         else if(head_ > tasks_.size()/2)
+         {
+            tasks_.erase(tasks_.begin(), std::next(tasks_.begin(), static_cast<std::ptrdiff_t>(head_)));
+            head_ = 0;
+         }
+      }
+
+      if(governor_ && !token.owns_token())
+         token = concurrency_token{*governor_};
+      else if(governor_)
+         governor_->yield();
+
+      std::exception_ptr error;
+#ifdef _MSC_VER
+   #pragma warning( push )
+   #pragma warning( disable: 4571 ) // Informational: catch(...) semantics changed since Visual C++ 7.1; structured exceptions (SEH) are no longer caught
+#endif
+      for(auto& t : batch)
+      {
+         try
+         {
+            function_(t);
+         }
+         catch(...)
+         {
+            if(!error)
+               error = std::current_exception();
+         }
+      }
+#ifdef _MSC_VER
+   #pragma warning( pop )
+#endif
+
+      bool all_done {false};
+      {  std::lock_guard<std::mutex> l(mutex_);
+         unfinished_ -= batch.size();
+         all_done = 0==unfinished_;
+         if(error && !error_)
+            error_ = error;
+      }
+      if(all_done)
+         all_done_.notify_all();
+      batch.clear();
+   }
+}
+
+/**
+   \brief typed_thread_pool<TASK_T, the type of 'f'>, e.g. of a lambda (C++14 does not deduce class template arguments).
+   The pool is not movable (the workers refer to it), so it is returned by a pointer
+*/
+template <typename TASK_T, typename Function>
+inline
+std::unique_ptr<typed_thread_pool<TASK_T, std::decay_t<Function>>>
+make_typed_thread_pool(Function&& f, size_t n = available_concurrency(), concurrency_governor* g = nullptr)
+{
+   return std::make_unique<typed_thread_pool<TASK_T, std::decay_t<Function>>>(std::forward<Function>(f), n, g);
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_TYPED_THREAD_POOL_INCLUDED_
@@ -0,0 +1,276 @@
+#ifndef _THREAD_EX_WHEN_INCLUDED_
+#define _THREAD_EX_WHEN_INCLUDED_
+
+/**
+	\file 	te_when.h
+	\brief  	some usefull thread primitives which are not included into std (since C++11)
+	\author 	Alexander Nikolayenko
+	\date		2026-10-18
+	\copyright 	GNU Public License.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <memory>
+#include <future>
+#include <vector>
+#include <tuple>
+#include <iterator>
+#include <exception>
+#include <utility>
+#include <type_traits>
+#include "te_compiler_warning_rollback.h"
+#include "te_compiler.h"
+#include "te_observable_future.h"
+#include "te_thread_cache.h"
+
+/**
+   \brief when_all and when_any combine several futures into one, without polling and without a thread blocked per future
+
+   - when_all: the future is ready when all the futures are ready, its value is the futures themselves (std::vector or std::tuple)
+   - when_any: the future is ready when one of them is ready, its value is when_any_result {index of the ready one, the futures}
+   - the combined future is observable_future, so the combinators nest
+
+   The futures are moved into the combinator. Observable futures (thread_pool::submit, call_async(pooled, ...)) are combined by completion callbacks:
+   the producer which makes the last (when_all) or the first (when_any) future ready makes the combined one ready.
+   A plain std::future (e.g. std::async, call_async(f, ...)) has no callbacks, 'observe' waits for it on a cached thread (see te_thread_cache.h)
+   and forwards its value or exception to an observable future.
+
+   \remark "Concurrency TS" (ISO/IEC TS 19571:2016), std::experimental::when_all, std::experimental::when_any
+   \example unit/test_when.cpp
+*/
+
+namespace thread_ex
+{
+
+template <typename Sequence>
+struct when_any_result
+{
+   size_t      index;      // of the ready future, size_t(-1) for an empty sequence
+   Sequence    futures;
+};
+
+   // the observable future itself
+template <typename T>
+inline
+observable_future<T> observe(observable_future<T>&& f) noexcept
+{
+   return std::move(f);
+}
+
+   // an observable future which gets the value (or the exception) of 'f' once it is ready, a cached thread waits for 'f'
+template <typename T>
+observable_future<T> observe(std::future<T>&&);
+
+namespace wis // when_internals
+{
+   template <typename T>
+   inline void transfer(std::future<T>& from, std::promise<T>& to)   { to.set_value(from.get()); }
+   inline void transfer(std::future<void>& from, std::promise<void>& to)   { from.get(); to.set_value(); }
+
+   template <typename T>
+   using observed_t = decltype(observe(std::declval<T>()));
+
+   template <typename T>            struct is_future                        : std::false_type {};
+   template <typename T>            struct is_future<std::future<T>>        : std::true_type {};
+   template <typename T>            struct is_future<observable_future<T>>  : std::true_type {};
+
+   template <bool... B>             struct bool_pack {};
+   template <typename... T>
+   using all_futures = std::is_same<bool_pack<true, is_future<std::decay_t<T>>::value...>, bool_pack<is_future<std::decay_t<T>>::value..., true>>;
+
+   template <typename Sequence, typename Value>
+   struct state_base
+   {
+      Sequence                            futures;
+      std::promise<Value>                 promise;
+      std::shared_ptr<ofis::completion_cell> cell {std::make_shared<ofis::completion_cell>()};
+
+      explicit state_base(Sequence&& s) : futures(std::move(s)) {}
+      observable_future<Value> get_future() { return observable_future<Value>{promise.get_future(), cell}; }
+   };
+
+   template <typename Sequence>
+   struct all_state : state_base<Sequence, Sequence>
+   {
+         // +1 is the subscriber, the futures are given away once all of them are subscribed to
+      std::atomic<size_t>  pending;
+
+      all_state(Sequence&& s, size_t n) : state_base<Sequence, Sequence>(std::move(s)), pending(n+1) {}
+      void ready(size_t)
+      {
+         if(1!=pending.fetch_sub(1, std::memory_order_acq_rel))
+            return;
+         this->promise.set_value(std::move(this->futures));
+         this->cell->complete();
+      }
+   };
+
+   template <typename Sequence>
+   struct any_state : state_base<Sequence, when_any_result<Sequence>>
+   {
+      std::atomic_bool     fired    {false};
+      size_t               index    {static_cast<size_t>(-1)};
+         // the first ready future and the subscriber, the futures are given away once all of them are subscribed to
+      std::atomic<size_t>  pending  {2};
+
+      explicit any_state(Sequence&& s) : state_base<Sequence, when_any_result<Sequence>>(std::move(s)) {}
+      void ready(size_t i)
+      {
+         if(fired.exchange(true, std::memory_order_acq_rel))
+            return;
+         index = i;
+         done();
+      }
+      void done()
+      {
+         if(1!=pending.fetch_sub(1, std::memory_order_acq_rel))
+            return;
+         this->promise.set_value(when_any_result<Sequence>{index, std::move(this->futures)});
+         this->cell->complete();
+      }
+   };
+
+   template <typename State, typename T>
+   inline void subscribe(const std::shared_ptr<State>& s, size_t i, observable_future<T>& f)
+   {
+      f.on_ready([s,i] { s->ready(i); });
+   }
+
+   template <typename State, typename T>
+   inline void subscribe_all(const std::shared_ptr<State>& s, std::vector<T>& futures)
+   {
+      for(size_t i = 0; i < futures.size(); ++i)
+         subscribe(s, i, futures[i]);
+   }
+
+   template <typename State, typename... T, size_t... I>
+   inline void subscribe_all(const std::shared_ptr<State>& s, std::tuple<T...>& futures, std::index_sequence<I...>)
+   {
+      using expander = int[];
+      (void)expander{0, (subscribe(s, I, std::get<I>(futures)), 0)...};
+   }
+
+   template <typename State, typename... T>
+   inline void subscribe_all(const std::shared_ptr<State>& s, std::tuple<T...>& futures)
+   {
+      subscribe_all(s, futures, std::index_sequence_for<T...>{});
+   }
+
+   template <typename T>
+   inline size_t sequence_size(const std::vector<T>& futures) noexcept { return futures.size(); }
+   template <typename... T>
+   inline size_t sequence_size(const std::tuple<T...>&) noexcept { return sizeof...(T); }
+
+   template <typename Sequence>
+   inline observable_future<Sequence> when_all(Sequence&& futures)
+   {
+      const size_t n = sequence_size(futures);
+      auto s = std::make_shared<all_state<Sequence>>(std::move(futures), n);
+      auto result = s->get_future();
+      subscribe_all(s, s->futures);
+      s->ready(n);
+      return result;
+   }
+
+   template <typename Sequence>
+   inline observable_future<when_any_result<Sequence>> when_any(Sequence&& futures)
+   {
+      const bool empty = 0==sequence_size(futures);
+      auto s = std::make_shared<any_state<Sequence>>(std::move(futures));
+      auto result = s->get_future();
+      subscribe_all(s, s->futures);
+      if(empty)
+         s->ready(static_cast<size_t>(-1));
+      s->done();
+      return result;
+   }
+
+   template <typename InputIt>
+   using observed_vector = std::vector<observed_t<typename std::iterator_traits<InputIt>::value_type>>;
+
+   template <typename InputIt>
+   inline observed_vector<InputIt> observe_all(InputIt first, InputIt last)
+   {
+      observed_vector<InputIt> futures;
+      for(; first!=last; ++first)
+         futures.push_back(observe(std::move(*first)));
+      return futures;
+   }
+}  // end of 'when_internals'
+
+template <typename T>
+inline
+observable_future<T> observe(std::future<T>&& f)
+{
+   std::promise<T> p;
+   auto cell = std::make_shared<ofis::completion_cell>();
+   observable_future<T> result {p.get_future(), cell};
+
+#ifdef _MSC_VER
+   #pragma warning( push )
+   #pragma warning( disable: 4571 ) // Informational: catch(...) semantics changed since Visual C++ 7.1; structured exceptions (SEH) are no longer caught
+   #pragma warning( disable: 4625 ) // '<lambda_...>': copy constructor was implicitly defined as deleted
+#endif
+
+   auto waiter = [from=std::move(f),to=std::move(p)]() mutable {
+      try
+      {
+         wis::transfer(from, to);
+      }
+      catch(...)
+      {
+         to.set_exception(std::current_exception());
+      }
+   };
+
+#ifdef _MSC_VER
+   #pragma warning( pop )
+#endif
+
+   default_thread_cache().execute(ofis::notifying<decltype(waiter)>{std::move(cell), std::move(waiter)});
+   return result;
+}
+
+/**
+   \brief the future is ready when all the futures of [first,last) are ready. The futures are moved from the range
+*/
+template <typename InputIt>
+inline
+observable_future<wis::observed_vector<InputIt>>
+when_all(InputIt first, InputIt last)
+{
+   return wis::when_all(wis::observe_all(first, last));
+}
+
+template <typename... Futures, typename = std::enable_if_t<wis::all_futures<Futures...>::value>>
+inline
+observable_future<std::tuple<wis::observed_t<Futures>...>>
+when_all(Futures&&... futures)
+{
+   return wis::when_all(std::tuple<wis::observed_t<Futures>...>{observe(std::forward<Futures>(futures))...});
+}
+
+/**
+   \brief the future is ready when one of the futures of [first,last) is ready. The futures are moved from the range
+*/
+template <typename InputIt>
+inline
+observable_future<when_any_result<wis::observed_vector<InputIt>>>
+when_any(InputIt first, InputIt last)
+{
+   return wis::when_any(wis::observe_all(first, last));
+}
+
+template <typename... Futures, typename = std::enable_if_t<wis::all_futures<Futures...>::value>>
+inline
+observable_future<when_any_result<std::tuple<wis::observed_t<Futures>...>>>
+when_any(Futures&&... futures)
+{
+   return wis::when_any(std::tuple<wis::observed_t<Futures>...>{observe(std::forward<Futures>(futures))...});
+}
+
+} // namespace thread_ex
+
+#endif //_THREAD_EX_WHEN_INCLUDED_
@@ -0,0 +1,71 @@
+/**
+   parallel_inclusive_scan vs std::partial_sum
+
+   The scan is memory bound: the two-pass algorithm reads every element twice, so it pays off with more than two workers
+   and a range that does not fit into the caches. 'blocks' of the scan is the number of workers.
+
+   g++ -std=c++14 -O2 -I../../include -pthread bench_scan.cpp -o bench_scan
+   ./bench_scan [workers] [elements]
+*/
+
+#include <te_parallel_scan.h>
+#include <te_thread_pool.h>
+#include "te_compiler_warning_suppress.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+#include <algorithm>
+#include "te_compiler_warning_rollback.h"
+
+namespace
+{
+   using namespace std::chrono;
+   using thread_ex::thread_pool;
+
+   template <typename Function>
+   double best_of(size_t runs, Function f)
+   {
+      double best {1e300};
+      for(size_t r = 0; r < runs; ++r)
+      {
+         const auto start = steady_clock::now();
+         f();
+         best = std::min(best, duration<double, std::milli>(steady_clock::now() - start).count());
+      }
+      return best;
+   }
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[])
+{
+   const size_t workers  = argc > 1? std::strtoul(argv[1], nullptr, 10) : std::max<size_t>(2, thread_ex::available_concurrency());
+   const size_t elements = argc > 2? std::strtoul(argv[2], nullptr, 10) : size_t{1} << 24;
+   constexpr size_t runs = 5;
+
+   thread_pool pool {workers};
+
+   std::vector<std::uint64_t> in(elements), sequential(elements), parallel(elements);
+   for(size_t i = 0; i < elements; ++i)
+      in[i] = i % 1013;
+
+   const double partial_sum = best_of(runs, [&] {
+      std::partial_sum(in.begin(), in.end(), sequential.begin());
+   });
+   const double scan = best_of(runs, [&] {
+      thread_ex::parallel_inclusive_scan(pool, in.begin(), in.end(), parallel.begin(), std::plus<>{}, workers);
+   });
+   if(sequential!=parallel)
+   {
+      std::printf("the results differ\n");
+      return 1;
+   }
+
+   std::printf("%zu workers, %zu elements\n", workers, elements);
+   std::printf("std::partial_sum         : %8.2f ms\n", partial_sum);
+   std::printf("parallel_inclusive_scan  : %8.2f ms (x%.2f)\n", scan, partial_sum/scan);
+   return 0;
+}
@@ -0,0 +1,98 @@
+/**
+   task_graph vs waves of thread_pool::submit with a barrier (waiting for all the futures) after every wave
+
+   The graph is layered: a node depends on two nodes of the previous layer, every 8th node is 10 times longer than the others.
+   The waves wait for the longest node of a layer, the graph starts a node the moment its two predecessors are done.
+
+   g++ -std=c++14 -O2 -I../../include -pthread bench_task_graph.cpp -o bench_task_graph
+   ./bench_task_graph [workers] [layers] [width]
+*/
+
+#include <te_task_graph.h>
+#include <te_thread_pool.h>
+#include "te_compiler_warning_suppress.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <vector>
+#include <algorithm>
+#include "te_compiler_warning_rollback.h"
+
+namespace
+{
+   using namespace std::chrono;
+   using thread_ex::task_graph;
+   using thread_ex::thread_pool;
+
+   void spin(microseconds d)
+   {
+      const auto until = steady_clock::now() + d;
+      while(steady_clock::now() < until)
+         ;
+   }
+
+   microseconds cost(size_t layer, size_t i)
+   {
+      return 0==(layer*7 + i)%8? microseconds(500) : microseconds(50);
+   }
+
+   template <typename Function>
+   double best_of(size_t runs, Function f)
+   {
+      double best {1e300};
+      for(size_t r = 0; r < runs; ++r)
+      {
+         const auto start = steady_clock::now();
+         f();
+         best = std::min(best, duration<double, std::milli>(steady_clock::now() - start).count());
+      }
+      return best;
+   }
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[])
+{
+   const size_t workers = argc > 1? std::strtoul(argv[1], nullptr, 10) : std::max<size_t>(2, thread_ex::available_concurrency());
+   const size_t layers  = argc > 2? std::strtoul(argv[2], nullptr, 10) : 50;
+   const size_t width   = argc > 3? std::strtoul(argv[3], nullptr, 10) : 4*workers;
+   constexpr size_t runs = 5;
+
+   thread_pool pool {workers};
+
+   const double waves = best_of(runs, [&] {
+      for(size_t l = 0; l < layers; ++l)
+      {
+         std::vector<std::future<void>> wave;
+         wave.reserve(width);
+         for(size_t i = 0; i < width; ++i)
+            wave.push_back(pool.submit([l,i] { spin(cost(l,i)); }));
+         for(auto& f : wave)
+            f.get();
+      }
+   });
+
+   task_graph graph;
+   std::vector<task_graph::node_id> previous, current;
+   for(size_t l = 0; l < layers; ++l)
+   {
+      current.clear();
+      for(size_t i = 0; i < width; ++i)
+      {
+         current.push_back(graph.add([l,i] { spin(cost(l,i)); }));
+         if(l)
+         {
+            graph.precede(previous[i], current.back());
+            graph.precede(previous[(i+1)%width], current.back());
+         }
+      }
+      previous.swap(current);
+   }
+   const double dag = best_of(runs, [&] { graph.run(pool); });
+
+   std::printf("%zu workers, %zu layers x %zu nodes\n", workers, layers, width);
+   std::printf("waves + barrier : %8.2f ms\n", waves);
+   std::printf("task_graph      : %8.2f ms (x%.2f)\n", dag, waves/dag);
+   return 0;
+}
@@ -0,0 +1,116 @@
+#include <te_actor.h>
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+#include "test_helpers.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("actor");
+
+   using thread_ex::actor;
+   using thread_ex::thread_pool;
+   using namespace std;
+   using namespace std::chrono_literals;
+   using test_helpers::eventually;
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("messages are handled in order, one at a time");
+
+      thread_pool tp {4};
+
+      vector<int> seen;
+      atomic<size_t> inside {0};
+      atomic<bool> overlapped {false};
+      actor<int> a {tp, [&](int&& m) {
+         if(1!=++inside)
+            overlapped = true;
+         seen.push_back(m);
+         --inside;
+      }, 8};
+
+      constexpr int N = 1000;
+      vector<thread> senders;
+      for(int s=0; s<2; ++s)   // two senders, the messages of a sender keep their order
+         senders.emplace_back([&a,s] { for(int i=0; i<N; ++i) a.send(s*N+i); });
+      for(auto& t : senders)
+         t.join();
+
+      ensure(eventually([&a] { return 0==a.pending(); }));
+      ensure(!overlapped);
+      ensure(2*N==seen.size());
+      int last[2] {-1,-1};
+      for(int m : seen)
+      {
+         ensure(last[m/N] < m);
+         last[m/N] = m;
+      }
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("100k actors on a few workers");
+
+      thread_pool tp {2};
+
+      constexpr size_t N = 100000;
+      atomic<size_t> handled {0};
+      vector<actor<size_t>> actors;
+      actors.reserve(N);
+      for(size_t i=0; i<N; ++i)
+         actors.emplace_back(tp, [&handled](size_t&& m) { handled += m; });
+      for(size_t round=0; round<3; ++round)
+         for(auto& a : actors)
+            a.send(1);
+      ensure(eventually([&handled] { return 3*N==handled; }));
+      ensure(2==tp.thread_count());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("actors talk to each other");
+
+      thread_pool tp {2};
+
+         // ping-pong of a counter, every actor forwards it to the other one until it reaches the limit
+      auto done = make_shared<promise<int>>();
+      shared_ptr<actor<int>> ping, pong;
+      ping = make_shared<actor<int>>(tp, [&pong,done](int&& n) { if(n>=100) done->set_value(n); else pong->send(n+1); });
+      pong = make_shared<actor<int>>(tp, [&ping](int&& n) { ping->send(n+1); });
+      ping->send(0);
+      auto f = done->get_future();
+      ensure(future_status::ready==f.wait_for(10s));
+      ensure(100==f.get());
+
+         // a copy is the same actor
+      string text;
+      actor<string> writer {tp, [&text](string&& s) { text += s; }, 1};
+      actor<string> same {writer};
+      writer.send("a");
+      same.send(string("b"));
+      ensure(eventually([&writer] { return 0==writer.pending(); }));
+      ensure("ab"==text);
+   }
+
+} // namespace tut
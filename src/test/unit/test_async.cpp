@@ -107,5 +107,20 @@ namespace tut
 
    }
 
+   template<>
+   template<>
+   void test_instance::test<5>()
+   {
+      set_test_name("async, pointer to member function");
+
+      struct counter
+      {
+         int base;
+         int add(int a) const { return base + a; }
+      };
+      const counter c {40};
+      ensure(42==call_async(&counter::add, &c, 2).get());
+   }
+
 } // namespace tut
 
@@ -0,0 +1,128 @@
+#include <te_async_mutex.h>
+
+#if defined(__cpp_impl_coroutine)
+
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+#include "test_helpers.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("async_mutex");
+
+   using thread_ex::async_mutex;
+   using thread_ex::detached_task;
+   using thread_ex::resume_on;
+   using thread_ex::thread_pool;
+   using namespace std;
+   using test_helpers::eventually;
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("lock, try_lock & unlock");
+
+      async_mutex m;
+      ensure(m.try_lock());
+      ensure(!m.try_lock());
+
+      vector<int> order;
+      auto locker = [&](int id) -> detached_task {
+         co_await m.lock();
+         order.push_back(id);
+         m.unlock();
+      };
+      locker(1);
+      locker(2);
+      locker(3);
+      ensure(order.empty());   // all wait for the owner
+      m.unlock();              // handed over in FIFO order, resumed by this thread
+      ensure((vector<int>{1,2,3})==order);
+
+      ensure(m.try_lock());
+      m.unlock();
+
+      auto scoped = [&]() -> detached_task {
+         auto guard = co_await m.scoped_lock();
+         order.push_back(4);
+      };
+      scoped();
+      ensure(4==order.size());
+      ensure(m.try_lock());    // unlocked by the guard
+      m.unlock();
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("mutual exclusion of coroutines on the pool");
+
+      thread_pool tp {2};
+
+      constexpr size_t N = 1000;
+      async_mutex m {tp};
+      size_t count {0};
+      atomic<size_t> inside {0};
+      atomic<bool> overlapped {false};
+      atomic<size_t> done {0};
+      auto task = [&]() -> detached_task {
+         co_await resume_on(tp);
+         {
+            auto guard = co_await m.scoped_lock();
+            if(1!=++inside)
+               overlapped = true;
+            co_await resume_on(tp);    // the owner is suspended, it may be resumed by another worker
+            ++count;
+            --inside;
+         }
+         ++done;
+      };
+      for(size_t i=0; i<N; ++i)
+         task();
+      ensure(eventually([&] { return N==done; }));
+      ensure(N==count);
+      ensure(!overlapped);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("a waiter does not block the worker");
+
+      thread_pool tp {1};
+
+      async_mutex m {tp};
+      ensure(m.try_lock());    // owned by this thread
+      atomic<size_t> done {0};
+      auto task = [&]() -> detached_task {
+         co_await resume_on(tp);
+         auto guard = co_await m.scoped_lock();
+         ++done;
+      };
+      for(size_t i=0; i<100; ++i)
+         task();
+      ensure(7==tp.submit([] { return 7; }).get());   // the only worker is free
+      ensure(0==done);
+      m.unlock();
+      ensure(eventually([&] { return 100==done; }));
+   }
+
+} // namespace tut
+
+#endif // __cpp_impl_coroutine
@@ -0,0 +1,128 @@
+#include <te_async_queue.h>
+
+#if defined(__cpp_impl_coroutine)
+
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+#include "test_helpers.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("async_queue");
+
+   using thread_ex::async_queue;
+   using thread_ex::detached_task;
+   using thread_ex::resume_on;
+   using thread_ex::thread_pool;
+   using namespace std;
+   using test_helpers::eventually;
+
+   detached_task consume(async_queue<int>& q, atomic<int>& sum, atomic<size_t>& done)
+   {
+      sum += co_await q.pop();
+      ++done;
+   }
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("stored values & waiters resumed by the pusher");
+
+      async_queue<string> q;
+      q.push("a");
+      q.push(string("b"));
+      ensure(2==q.size());
+
+      vector<string> seen;
+      auto reader = [&]() -> detached_task {
+         for(size_t i=0; i<4; ++i)
+            seen.push_back(co_await q.pop());
+      };
+      reader();   // takes the stored ones and waits
+      ensure(2==seen.size());
+      ensure(q.empty());
+
+      q.push("c");   // the waiter is resumed by this thread, at once
+      ensure(3==seen.size());
+      q.push("d");
+      ensure((vector<string>{"a","b","c","d"})==seen);
+
+      string out;
+      ensure(!q.try_pop(out));
+      q.push("e");
+      ensure(q.try_pop(out) && "e"==out);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("thousands of waiting coroutines on one worker");
+
+      thread_pool tp {1};
+
+      constexpr int N = 5000;
+      async_queue<int> q {tp};
+      atomic<int> sum {0};
+      atomic<size_t> done {0};
+      for(int i=0; i<N; ++i)
+         consume(q, sum, done);
+      ensure(0==done);
+         // the only worker is free
+      ensure(7==tp.submit([] { return 7; }).get());
+
+      for(int i=1; i<=N; ++i)
+         q.push(i);
+      ensure(eventually([&] { return N==done; }));
+      ensure(N*(N+1)/2==sum);
+      ensure(q.empty());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("move-only values, producers & consumers on the pool");
+
+      thread_pool tp {2};
+
+      constexpr size_t N = 1000;
+      async_queue<unique_ptr<size_t>> q {tp};
+      atomic<size_t> sum {0};
+      atomic<size_t> done {0};
+      auto consumer = [&]() -> detached_task {
+         co_await resume_on(tp);
+         for(size_t i=0; i<N; ++i)
+            sum += *co_await q.pop();
+         ++done;
+      };
+      consumer();
+      consumer();
+      vector<thread> producers;
+      for(size_t p=0; p<2; ++p)
+         producers.emplace_back([&q] { for(size_t i=1; i<=N; ++i) q.push(make_unique<size_t>(i)); });
+      for(auto& t : producers)
+         t.join();
+      ensure(eventually([&] { return 2==done; }));
+      ensure(N*(N+1)==sum);
+   }
+
+} // namespace tut
+
+#endif // __cpp_impl_coroutine
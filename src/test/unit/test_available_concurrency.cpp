@@ -0,0 +1,147 @@
+#include <te_available_concurrency.h>
+#include "te_compiler_warning_suppress.h"
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+#include "test_helpers.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("available_concurrency");
+
+   using thread_ex::available_concurrency;
+   using thread_ex::cgroup_concurrency;
+   using thread_ex::concurrency_sources;
+   using thread_ex::detect_concurrency;
+   using namespace std;
+
+#ifndef _WIN32
+      // a fake /sys/fs/cgroup and /proc/self/cgroup, removed by the destructor
+   struct cgroup_fixture : test_helpers::temp_directory
+   {
+      cgroup_fixture() : temp_directory("/tmp/te_cgroup_") {}
+
+      size_t limit()
+      {
+         return cgroup_concurrency(root + "/sys", root + "/cgroup");
+      }
+   };
+#endif
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("the process");
+
+      const size_t n = available_concurrency();
+      ensure(n >= 1);
+      ensure(n==available_concurrency());
+      ensure(n==detect_concurrency());    // no quota, affinity or override changes within the test
+
+      concurrency_sources none;
+      none.environment.clear();
+      none.cgroup_root.clear();
+      none.affinity = false;
+      ensure(max(1u, thread::hardware_concurrency())==detect_concurrency(none));
+   }
+
+#ifndef _WIN32
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("cgroup v2");
+
+      {  cgroup_fixture f;
+         f.write("/cgroup", "0::/");
+         ensure(0==f.limit());      // no files, no limit
+         f.write("/sys/cpu.max", "max 100000");
+         ensure(0==f.limit());
+         f.write("/sys/cpu.max", "400000 100000");
+         ensure(4==f.limit());
+         f.write("/sys/cpu.max", "250000 100000");
+         ensure(3==f.limit());      // rounded up
+         f.write("/sys/cpu.max", "50000 100000");
+         ensure(1==f.limit());
+      }
+      {  cgroup_fixture f;          // the cgroup of the process and its parents
+         f.write("/cgroup", "0::/kubepods/pod1/container\n");
+         f.write("/sys/kubepods/pod1/container/cpu.max", "max 100000");
+         f.write("/sys/kubepods/pod1/cpu.max", "600000 100000");
+         f.write("/sys/kubepods/cpu.max", "800000 100000");
+         ensure(6==f.limit());
+         f.write("/sys/kubepods/pod1/container/cpuset.cpus.effective", "0-1,4");
+         ensure(3==f.limit());
+      }
+      {  cgroup_fixture f;          // the cgroup path of the host inside the container namespace
+         f.write("/cgroup", "0::/system.slice/docker-1234.scope");
+         f.write("/sys/cpu.max", "200000 100000");
+         ensure(2==f.limit());
+      }
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("cgroup v1");
+
+      cgroup_fixture f;
+      f.write("/cgroup", "12:memory:/docker/abc\n7:cpuset:/docker/abc\n4:cpu,cpuacct:/docker/abc\n1:name=systemd:/docker/abc\n");
+      ensure(0==f.limit());
+      f.write("/sys/cpu,cpuacct/docker/abc/cpu.cfs_quota_us", "-1");
+      f.write("/sys/cpu,cpuacct/docker/abc/cpu.cfs_period_us", "100000");
+      ensure(0==f.limit());
+      f.write("/sys/cpu,cpuacct/docker/abc/cpu.cfs_quota_us", "150000");
+      ensure(2==f.limit());
+      f.write("/sys/cpuset/docker/abc/cpuset.cpus", "3");
+      ensure(1==f.limit());
+      f.write("/sys/cpuset/docker/abc/cpuset.cpus", "0-7");
+      f.write("/sys/cpuset/docker/abc/cpuset.effective_cpus", "2-4");
+      ensure(2==f.limit());
+      f.write("/sys/cpu,cpuacct/docker/abc/cpu.cfs_quota_us", "-1");
+      ensure(3==f.limit());
+      f.write("/sys/cpuset/docker/abc/cpuset.effective_cpus", "garbage");
+      ensure(8==f.limit());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("the environment variable and the detector");
+
+      cgroup_fixture f;
+      f.write("/cgroup", "0::/");
+      f.write("/sys/cpu.max", "100000 100000");
+
+      concurrency_sources sources;
+      sources.environment = "TE_TEST_CONCURRENCY";
+      sources.cgroup_root = f.root + "/sys";
+      sources.proc_cgroup = f.root + "/cgroup";
+      unsetenv("TE_TEST_CONCURRENCY");
+      ensure(1==detect_concurrency(sources));   // the quota of 1 CPU
+
+      setenv("TE_TEST_CONCURRENCY", "96", 1);
+      ensure(96==detect_concurrency(sources));  // overridden as is
+      setenv("TE_TEST_CONCURRENCY", "0", 1);
+      ensure(1==detect_concurrency(sources));
+      setenv("TE_TEST_CONCURRENCY", "4x", 1);
+      ensure(1==detect_concurrency(sources));
+      unsetenv("TE_TEST_CONCURRENCY");
+   }
+#endif // _WIN32
+
+} // namespace tut
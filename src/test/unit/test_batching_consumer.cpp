@@ -0,0 +1,181 @@
+#include <te_batching_consumer.h>
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+#include "test_helpers.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("batching_consumer");
+
+   using thread_ex::batching_consumer;
+   using namespace std;
+   using namespace std::chrono_literals;
+   using test_helpers::eventually;
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("size threshold");
+
+      mutex m;
+      vector<size_t> sizes;
+      vector<int> seen;
+      {
+         batching_consumer<int> c {[&](vector<int>& batch) {
+            lock_guard<mutex> l(m);
+            sizes.push_back(batch.size());
+            seen.insert(seen.end(), batch.begin(), batch.end());
+         }, 10, 1h};
+
+         for(int i=0; i<10; ++i)
+            c.push(i);
+         ensure(eventually([&] { lock_guard<mutex> l(m); return 1==sizes.size(); }));
+         ensure(10==sizes[0]);
+
+         c.push(10);   // below the threshold, the deadline is far away: handed over by the destructor
+         this_thread::sleep_for(50ms);
+         lock_guard<mutex> l(m);
+         ensure(1==sizes.size());
+      }
+      ensure(2==sizes.size());
+      ensure(1==sizes[1]);
+      ensure(11==seen.size());
+      for(int i=0; i<11; ++i)
+         ensure(i==seen[i]);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("deadline & flush");
+
+      atomic<size_t> batches {0};
+      atomic<size_t> elements {0};
+      batching_consumer<string> c {[&](vector<string>& batch) {
+         elements += batch.size();
+         ++batches;
+      }, 1000, 20ms};
+
+      const auto start = chrono::steady_clock::now();
+      c.push("a");
+      c.push(string("b"));
+      ensure(eventually([&] { return 1==batches; }));
+      ensure(chrono::steady_clock::now()-start >= 20ms);
+      ensure(2==elements);
+
+      batching_consumer<int> slow {[&](vector<int>& batch) { elements += batch.size(); ++batches; }, 1000, 1h};
+      slow.flush();   // nothing queued, nothing happens
+      slow.push(1);
+      ensure(1==slow.size());
+      slow.flush();
+      ensure(eventually([&] { return 2==batches; }));
+      ensure(3==elements);
+      ensure(0==slow.size());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("buffers are reused");
+
+      mutex m;
+      set<const int*> buffers;
+      set<size_t> capacities;
+      atomic<size_t> batches {0};
+      batching_consumer<int> c {[&](vector<int>& batch) {
+         lock_guard<mutex> l(m);
+         buffers.insert(batch.data());
+         capacities.insert(batch.capacity());
+         ++batches;
+      }, 16, 1h};
+
+      for(size_t round=1; round<=50; ++round)
+      {
+         for(int i=0; i<16; ++i)
+            c.push(i);
+         ensure(eventually([&] { return round==batches; }));
+      }
+      lock_guard<mutex> l(m);
+      ensure(2==buffers.size());   // double buffering, no allocations
+      ensure(1==capacities.size() && 16==*capacities.begin());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("many producers");
+
+      constexpr size_t N = 10000;
+      atomic<size_t> sum {0};
+      atomic<size_t> count {0};
+      {
+         batching_consumer<size_t> c {[&](vector<size_t>& batch) {
+            for(size_t v : batch)
+               sum += v;
+            count += batch.size();
+         }, 64, 1ms};
+
+         vector<thread> producers;
+         for(size_t p=0; p<4; ++p)
+            producers.emplace_back([&c] { for(size_t i=1; i<=N; ++i) c.push(i); });
+         for(auto& t : producers)
+            t.join();
+      }
+      ensure(4*N==count);
+      ensure(4*N*(N+1)/2==sum);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<5>()
+   {
+      set_test_name("no deadline");
+
+      mutex m;
+      vector<size_t> sizes;
+      {
+         batching_consumer<int> c {[&](vector<int>& batch) {
+            lock_guard<mutex> l(m);
+            sizes.push_back(batch.size());
+         }, 4, batching_consumer<int>::duration_type::max()};
+
+         for(int i=0; i<3; ++i)
+            c.push(i);
+         this_thread::sleep_for(50ms);   // below the threshold: not handed over one by one
+         {  lock_guard<mutex> l(m);
+            ensure(sizes.empty());
+         }
+         c.push(3);
+         ensure(eventually([&] { lock_guard<mutex> l(m); return 1==sizes.size(); }));
+         ensure(4==sizes[0]);
+
+         c.push(4);
+         c.flush();
+         ensure(eventually([&] { lock_guard<mutex> l(m); return 2==sizes.size(); }));
+         ensure(1==sizes[1]);
+      }
+      ensure(2==sizes.size());
+   }
+
+} // namespace tut
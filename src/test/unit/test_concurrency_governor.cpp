@@ -0,0 +1,134 @@
+#include <te_concurrency_governor.h>
+#include <te_thread_pool.h>
+#include <te_runtime_concurrency.h>
+#include <te_async.h>
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <future>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("concurrency_governor");
+
+   using thread_ex::concurrency_governor;
+   using thread_ex::concurrency_token;
+   using thread_ex::thread_pool;
+   using namespace std;
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("tokens");
+
+      concurrency_governor g{2};
+      ensure(2==g.capacity());
+      ensure(2==g.available());
+      ensure(g.try_acquire());
+      ensure(g.try_acquire());
+      ensure(!g.try_acquire());
+      ensure(0==g.available());
+      g.release();
+      ensure(1==g.available());
+      {
+         concurrency_token t1 {g, try_to_lock};
+         concurrency_token t2 {g, try_to_lock};
+         ensure(t1.owns_token());
+         ensure(!t2.owns_token());
+         ensure(0==g.available());
+      }
+      ensure(1==g.available());
+      g.release();
+      ensure(2==g.available());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("acquire waits for release");
+
+      concurrency_governor g{1};
+      g.acquire();
+
+      atomic_bool acquired {false};
+      auto f = thread_ex::call_async([&]{
+         concurrency_token t {g};
+         acquired = true;
+      });
+      this_thread::sleep_for(chrono::milliseconds(50));
+      ensure(!acquired);
+
+      g.release();
+      f.get();
+      ensure(acquired);
+      ensure(1==g.available());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("two pools share one budget");
+
+      concurrency_governor g{2};
+      atomic<size_t> running {0};
+      atomic<size_t> peak    {0};
+
+      auto task = [&]{
+         const size_t now = ++running;
+         for(size_t p = peak; now > p && !peak.compare_exchange_weak(p,now););
+         this_thread::sleep_for(chrono::milliseconds(1));
+         --running;
+      };
+
+      vector<future<void>> results;
+      {
+         thread_pool a{thread_pool::deferred_start_type{}};
+         thread_pool b{thread_pool::deferred_start_type{}};
+         a.govern(&g);
+         b.govern(&g);
+         a.start(3);
+         b.start(3);
+         for(size_t i=0; i<100; ++i)
+         {
+            results.push_back(a.submit(task));
+            results.push_back(b.submit(task));
+         }
+         for(auto& r : results)
+            r.get();
+      }
+      ensure(peak <= 2);
+      ensure(2==g.available());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("runtime_concurrency respects tokens in use");
+
+      auto& g = concurrency_governor::global();
+      vector<concurrency_token> tokens;
+      for(concurrency_token t {g, try_to_lock}; t.owns_token(); t = concurrency_token{g, try_to_lock})
+         tokens.push_back(std::move(t));
+
+      ensure(1==thread_ex::runtime_concurrency(1000,1));
+      tokens.clear();
+      ensure(min<size_t>(g.capacity(),1000)==thread_ex::runtime_concurrency(1000,1));
+   }
+
+} // namespace tut
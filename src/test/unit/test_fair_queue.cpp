@@ -0,0 +1,127 @@
+#include <te_fair_queue.h>
+#include <te_thread_pool.h>
+#include "te_compiler_warning_suppress.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <future>
+#include <algorithm>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("fair_queue");
+
+   using thread_ex::fair_queue;
+   using thread_ex::thread_pool;
+   using thread_ex::task_options;
+   using namespace std;
+
+   string pop_all(fair_queue<char>& q)
+   {
+      string s;
+      for(char c; q.pop(nothrow,c);)
+         s += c;
+      return s;
+   }
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("round-robin between tenants");
+
+      fair_queue<char> q;
+      ensure(q.empty());
+      for(char c : string("aaaaaa"))
+         q.push(1,c);
+      q.push(2,'b');
+      q.push(2,'b');
+      q.push(3,'c');
+      ensure(9==q.size());
+      ensure("abcabaaaa"==pop_all(q));
+      ensure(q.empty());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("weights");
+
+      fair_queue<char> q;
+      q.set_weight(1,3);
+      for(size_t i=0; i<6; ++i)
+      {
+         q.push(1,'a');
+         q.push(2,'b');
+      }
+      ensure("aaabaaabbbbb"==pop_all(q));
+
+         // the turn starts over when a tenant gets active again
+      q.push(1,'a');
+      q.push(2,'b');
+      q.push(1,'a');
+      ensure("aab"==pop_all(q));
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("batch");
+
+      fair_queue<char> q;
+      for(size_t i=0; i<10; ++i)
+         q.push(1,'a');
+      q.push(2,'b');
+
+      fair_queue<char>::container_type batch;
+      ensure(4==q.pop(nothrow,batch,4));
+      ensure(4==q.pop(nothrow,batch,100,2));   // a half of 7 left
+      ensure(8==batch.size());
+      string s;
+      for(; !batch.empty(); batch.pop())
+         s += batch.front();
+      ensure("abaaaaaa"==s);
+      ensure(3==q.pop(nothrow,batch,100));
+      ensure(0==q.pop(nothrow,batch,100));
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("a small tenant of thread_pool is not starved by a heavy one");
+
+      mutex m;
+      vector<size_t> order;
+      auto task = [&](size_t tenant) { lock_guard<mutex> l(m); order.push_back(tenant); };
+
+      vector<future<void>> results;
+      {
+         thread_pool tp{thread_pool::deferred_start_type{}};
+         for(size_t i=0; i<1000; ++i)
+            results.push_back(tp.submit(task_options{"heavy",1},task,1));
+         results.push_back(tp.submit(task_options{"small",2},task,2));
+         tp.start(1);
+         for(auto& r : results)
+            r.get();
+      }
+      ensure(1001==order.size());
+      const auto small = find(begin(order), end(order), 2u);
+      ensure(end(order)!=small);
+      ensure(distance(begin(order),small) < 2);
+   }
+
+} // namespace tut
@@ -0,0 +1,172 @@
+#ifndef _WIN32
+
+#include <te_fiber.h>
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+#include "test_helpers.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("fiber");
+
+   using thread_ex::fiber_executor;
+   using thread_ex::fiber_mutex;
+   using thread_ex::fiber_queue;
+   using thread_ex::thread_pool;
+   namespace this_fiber = thread_ex::this_fiber;
+   using namespace std;
+   using namespace std::chrono_literals;
+   using test_helpers::eventually;
+
+   int deep(int depth)   // a call stack kept across the suspensions
+   {
+      if(0==depth)
+         return 0;
+      this_fiber::yield();
+      return 1 + deep(depth-1);
+   }
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("spawn & yield");
+
+      thread_pool tp {2};
+
+      ensure(!this_fiber::inside());
+      vector<future<int>> results;
+      {
+         fiber_executor fibers {tp};
+         ensure(fiber_executor::default_stack_size==fibers.stack_size());
+         for(int i=0; i<100; ++i)
+            results.push_back(fibers.spawn([](int n) { return this_fiber::inside()? deep(n) : -1; }, i));
+         auto failed = fibers.spawn([] { this_fiber::yield(); throw invalid_argument("fiber"); });
+         try
+         {
+            failed.get();
+            ensure(!"this line is not reachable");
+         }
+         catch(const invalid_argument& e)
+         {
+            ensure(string("fiber")==e.what());
+         }
+      }  // waits for the fibers
+      for(int i=0; i<100; ++i)
+         ensure(i==results[i].get());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("fiber_mutex");
+
+      thread_pool tp {2};
+
+      fiber_mutex m;
+      size_t count {0};
+      atomic<size_t> inside {0};
+      atomic<bool> overlapped {false};
+      auto critical = [&] {
+         lock_guard<fiber_mutex> l(m);
+         if(1!=++inside)
+            overlapped = true;
+         this_fiber::yield();    // the owner is suspended, the others are queued on the mutex
+         ++count;
+         --inside;
+      };
+      {
+         fiber_executor fibers {tp};
+         for(size_t i=0; i<500; ++i)
+            fibers.spawn(critical);
+         for(size_t i=0; i<100; ++i)   // a plain thread shares the mutex with the fibers
+            critical();
+      }
+      ensure(600==count);
+      ensure(!overlapped);
+      ensure(m.try_lock());
+      ensure(!m.try_lock());
+      m.unlock();
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("thousands of fibers blocked on a queue");
+
+      thread_pool tp {2};
+
+      constexpr size_t N = 2000;
+      fiber_queue<size_t> requests;
+      fiber_queue<size_t> replies;
+      atomic<size_t> waiting {0};
+      fiber_executor fibers {tp, 32*1024};
+      for(size_t i=0; i<N; ++i)
+         fibers.spawn([&] {
+            size_t v {0};
+            ++waiting;
+            requests.wait_pop(v);   // the worker is not blocked
+            replies.push(v*2);
+         });
+      ensure(eventually([&] { return N==waiting; }));
+      ensure(N==fibers.active());
+      ensure(2==tp.thread_count());
+
+      for(size_t i=1; i<=N; ++i)
+         requests.push(i);
+      size_t sum {0};
+      for(size_t i=0; i<N; ++i)
+      {
+         size_t v {0};
+         replies.wait_pop(v);    // a plain thread blocks
+         sum += v;
+      }
+      ensure(N*(N+1)==sum);
+      ensure(eventually([&] { return 0==fibers.active(); }));
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("a stop request wakes a fiber up");
+
+      thread_pool tp {1};
+
+      fiber_queue<int> q;
+      thread_ex::stop_source source;
+      fiber_executor fibers {tp};
+      auto stopped = fibers.spawn([&q,token=source.get_token()] {
+         int v {0};
+         return q.wait_pop(v, token);
+      });
+         // the only worker is free while the fiber waits
+      ensure(7==tp.submit([] { return 7; }).get());
+      ensure(future_status::timeout==stopped.wait_for(20ms));
+      source.request_stop();
+      ensure(future_status::ready==stopped.wait_for(10s));
+      ensure(!stopped.get());
+   }
+
+} // namespace tut
+
+#endif // _WIN32
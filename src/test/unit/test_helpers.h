@@ -0,0 +1,74 @@
+#ifndef _THREAD_EX_TEST_HELPERS_INCLUDED_
+#define _THREAD_EX_TEST_HELPERS_INCLUDED_
+
+/**
+   Helpers shared by the unit tests, they are not a part of the library.
+*/
+
+
+#include "te_compiler_warning_suppress.h"
+#include <chrono>
+#include <thread>
+#include <string>
+#include <fstream>
+#include <cerrno>
+#include <cstdio>
+#include <system_error>
+#ifndef _WIN32
+   #include <ftw.h>
+   #include <sys/stat.h>
+   #include <unistd.h>
+#endif
+#include "te_compiler_warning_rollback.h"
+
+namespace test_helpers
+{
+      // polls 'p' up to 10 seconds, for the tests of asynchronous work there is nothing to wait on
+   template <typename Predicate>
+   bool eventually(Predicate p)
+   {
+      for(size_t i=0; i<1000 && !p(); ++i)
+         std::this_thread::sleep_for(std::chrono::milliseconds{10});
+      return p();
+   }
+
+#ifndef _WIN32
+   inline int remove_entry(const char* path, const struct stat*, int, struct FTW*)
+   {
+      return std::remove(path);
+   }
+
+      // a fresh directory under /tmp (e.g. a fake sysfs), removed with all its content by the destructor
+   class temp_directory
+   {
+   public:
+      std::string root;
+
+         // 'prefix' - the name of the directory without its 6 random characters, e.g. "/tmp/te_sysfs_"
+      explicit temp_directory(const std::string& prefix)
+      {
+         std::string name = prefix + "XXXXXX";
+         if(!mkdtemp(&name[0]))
+            throw std::system_error(errno, std::generic_category(), "mkdtemp " + name);
+         root = name;
+      }
+      ~temp_directory()
+      {
+         nftw(root.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);    // the content first, symbolic links are not followed
+      }
+      temp_directory(const temp_directory&)              = delete;
+      temp_directory& operator=(const temp_directory&)   = delete;
+
+         // 'path' - relative to 'root' and starts with '/', the missing directories are created
+      void write(const std::string& path, const std::string& content) const
+      {
+         for(size_t slash = path.find('/', 1); slash!=std::string::npos; slash = path.find('/', slash + 1))
+            mkdir((root + path.substr(0, slash)).c_str(), 0700);
+         std::ofstream {root + path} << content << '\n';
+      }
+   };
+#endif
+
+} // namespace test_helpers
+
+#endif //_THREAD_EX_TEST_HELPERS_INCLUDED_
@@ -0,0 +1,144 @@
+#ifndef _WIN32
+
+#include <te_io_executor.h>
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <cstdlib>
+#include <future>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+#include "test_helpers.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("io_executor");
+
+   using thread_ex::io_executor;
+   using thread_ex::thread_pool;
+   using namespace std;
+   using test_helpers::eventually;
+
+   using backend = io_executor::backend;
+   const backend backends[] = {backend::io_uring, backend::threads};
+
+   struct temp_file   // removed on close
+   {
+      int fd {-1};
+      temp_file()    { char name[] = "/tmp/te_io_executor_XXXXXX"; fd = mkstemp(name); if(fd >= 0) unlink(name); }
+      ~temp_file()   { if(fd >= 0) close(fd); }
+   };
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("write & read into futures");
+
+      thread_pool tp {2};
+
+      for(backend b : backends)
+      {
+         temp_file file;
+         ensure(file.fd >= 0);
+         io_executor io {tp, 16, b};
+         ensure(backend::threads!=b || backend::threads==io.kind());
+
+         const string text = "0123456789abcdef";
+         ensure(text.size()==io.write(file.fd, text.data(), text.size(), 100).get());
+         string back(text.size(), ' ');
+         ensure(text.size()==io.read(file.fd, &back[0], back.size(), 100).get());
+         ensure(text==back);
+
+            // a short read at the end of the file
+         ensure(6==io.read(file.fd, &back[0], back.size(), 110).get());
+         ensure(0==io.read(file.fd, &back[0], back.size(), 1000).get());
+      }
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("many requests in flight, continuations on the pool");
+
+      thread_pool tp {1};
+
+      constexpr size_t block = 4096;
+      constexpr size_t N     = 512;
+      for(backend b : backends)
+      {
+         temp_file file;
+         ensure(file.fd >= 0);
+         vector<char> content(block*N);
+         for(size_t i=0; i<content.size(); ++i)
+            content[i] = static_cast<char>(i/block);
+         ensure(static_cast<ssize_t>(content.size())==pwrite(file.fd, content.data(), content.size(), 0));
+
+         vector<char> copy(content.size(), 0);
+         atomic<size_t> completed {0};
+         atomic<size_t> bytes {0};
+         atomic<bool> failed {false};
+         {
+            io_executor io {tp, 64, b};
+            ensure(64>=io.depth());
+            for(size_t i=0; i<N; ++i)
+               io.read(file.fd, &copy[i*block], block, i*block, [&](size_t n, error_code ec) {
+                  if(ec)
+                     failed = true;
+                  bytes += n;
+                  ++completed;
+               });
+            ensure(io.in_flight() <= io.depth());
+         }  // waits for the requests in flight
+         ensure(eventually([&] { return N==completed; }));   // the continuations are posted
+         ensure(!failed);
+         ensure(content.size()==bytes);
+         ensure(content==copy);
+      }
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("errors");
+
+      thread_pool tp {1};
+
+      for(backend b : backends)
+      {
+         io_executor io {tp, 4, b};
+         char buffer[16];
+         try
+         {
+            io.read(-1, buffer, sizeof(buffer), 0).get();
+            ensure(!"this line is not reachable");
+         }
+         catch(const system_error& e)
+         {
+            ensure(errc::bad_file_descriptor==e.code());
+         }
+
+         promise<error_code> result;
+         io.write(-1, buffer, sizeof(buffer), 0, [&result](size_t, error_code ec) { result.set_value(ec); });
+         ensure(errc::bad_file_descriptor==result.get_future().get());
+      }
+   }
+
+} // namespace tut
+
+#endif // _WIN32
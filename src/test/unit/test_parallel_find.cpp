@@ -0,0 +1,127 @@
+#include <te_parallel_find.h>
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("parallel_find");
+
+   using thread_ex::parallel_find_if;
+   using thread_ex::parallel_any_of;
+   using thread_ex::thread_pool;
+   using namespace std;
+
+   const size_t blocks[] = {0, 1, 2, 3, 7, 64, 1000000};   // 0 - by runtime_concurrency, the last one is more than elements
+
+   vector<int> sequence(size_t n)
+   {
+      vector<int> v(n);
+      iota(v.begin(), v.end(), 0);
+      return v;
+   }
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("the first match as std::find_if");
+
+      thread_pool tp {3};
+
+      for(size_t n : {0, 1, 5, 1000, 100003})
+         for(size_t b : blocks)
+         {
+            const auto v = sequence(n);
+            for(int target : {0, 1, 255, 256, 999, 50000, 100002, -1})
+            {
+                  // the multiples of 'target' match, so there are matches after the first one in the other blocks
+               auto multiple = [target](int i) { return target > 0? i >= target && 0==i%target : i==target; };
+               ensure(find_if(v.begin(), v.end(), multiple)==parallel_find_if(tp, v.begin(), v.end(), multiple, b));
+            }
+            ensure(v.end()==parallel_find_if(tp, v.begin(), v.end(), [](int) { return false; }, b));
+            ensure(v.begin()==parallel_find_if(tp, v.begin(), v.end(), [](int) { return true; }, b));
+         }
+
+         // the default pool
+      const auto v = sequence(200000);
+      ensure(v.begin() + 123456==parallel_find_if(v.begin(), v.end(), [](int i) { return 123456==i; }));
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("any_of");
+
+      thread_pool tp {2};
+
+      const auto v = sequence(100000);
+      for(size_t b : blocks)
+      {
+         ensure(parallel_any_of(tp, v.begin(), v.end(), [](int i) { return 77777==i; }, b));
+         ensure(!parallel_any_of(tp, v.begin(), v.end(), [](int i) { return i < 0; }, b));
+         ensure(!parallel_any_of(tp, v.begin(), v.begin(), [](int) { return true; }, b));
+      }
+      ensure(parallel_any_of(v.begin(), v.end(), [](int i) { return 99999==i; }));
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("early termination");
+
+      thread_pool tp {4};
+
+      const auto v = sequence(1000000);
+      atomic<size_t> visited {0};
+      const auto it = parallel_find_if(tp, v.begin(), v.end(), [&visited](int i) { ++visited; return 1000==i; }, 8);
+      ensure(v.begin() + 1000==it);
+      ensure(visited < v.size() / 2);    // the blocks after the match stop
+
+         // a worker busy with another task does not stall the search
+      atomic<bool> release {false};
+      for(size_t i = 0; i < 4; ++i)
+         tp.post([&release] { while(!release) this_thread::yield(); });
+      ensure(v.end() - 1==parallel_find_if(tp, v.begin(), v.end(), [](int i) { return 999999==i; }, 4));
+      release = true;
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("an exception of the predicate");
+
+      thread_pool tp {2};
+
+      const auto v = sequence(100000);
+      for(size_t b : {1, 4})
+         try
+         {
+            parallel_find_if(tp, v.begin(), v.end(), [](int i) -> bool { if(60000==i) throw runtime_error("60000"); return false; }, b);
+            ensure(!"this line is not reachable");
+         }
+         catch(const runtime_error& e)
+         {
+            ensure(string{"60000"}==e.what());
+         }
+      ensure(7==tp.submit([] { return 7; }).get());   // the pool is alive
+   }
+
+} // namespace tut
@@ -0,0 +1,171 @@
+#include <te_parallel_region.h>
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <vector>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("parallel_region");
+
+   using thread_ex::worker_team;
+   using thread_ex::team_ctx;
+   using namespace std;
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("every thread of the team runs the region");
+
+      worker_team team {4};
+      ensure(4==team.size());
+
+      vector<size_t> visits(4);
+      atomic<size_t> sizes {0};
+      team.parallel_region(4, [&](team_ctx& ctx) {
+         ++visits[ctx.thread_num()];
+         sizes += ctx.team_size();
+      });
+      ensure(vector<size_t>(4,1)==visits);
+      ensure(16==sizes);
+
+         // a smaller team, the team size is limited by the number of threads
+      atomic<size_t> count {0};
+      team.parallel_region(2, [&](team_ctx& ctx) { ensure(ctx.thread_num() < 2); ++count; });
+      ensure(2==count);
+      team.parallel_region(100, [&](team_ctx&) { ++count; });
+      ensure(6==count);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("iterations synchronised by barrier");
+
+      constexpr size_t threads    = 4;
+      constexpr size_t iterations = 200;
+
+         // every iteration the value of a cell is the sum of its value and the value of the neighbour from the previous iteration
+      vector<size_t> current(threads);
+      iota(begin(current), end(current), 1u);
+      vector<size_t> next(threads, 0);
+
+      vector<size_t> expected {current};
+      for(size_t k = 0; k < iterations; ++k)
+      {
+         vector<size_t> e(threads);
+         for(size_t i = 0; i < threads; ++i)
+            e[i] = expected[i] + expected[(i+1)%threads];
+         expected.swap(e);
+      }
+
+      worker_team team {threads};
+      team.parallel_region(threads, [&](team_ctx& ctx) {
+         const size_t i = ctx.thread_num();
+         auto* from = &current;
+         auto* to   = &next;
+         for(size_t k = 0; k < iterations; ++k)
+         {
+            (*to)[i] = (*from)[i] + (*from)[(i+1)%threads];
+            ctx.barrier();
+            swap(from,to);
+         }
+      });
+
+      const auto& result = iterations%2? next : current;
+      ensure(expected==result);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("single & master");
+
+      worker_team team {3};
+      atomic<size_t> singles {0};
+      atomic<size_t> masters {0};
+      vector<size_t> seen(3);
+      team.parallel_region(3, [&](team_ctx& ctx) {
+         for(size_t k = 0; k < 50; ++k)
+         {
+            ctx.single([&] { ++singles; });
+            seen[ctx.thread_num()] = singles;   // the implicit barrier: the single is done by now
+            ctx.master([&] { ++masters; });
+            ctx.barrier();
+         }
+      });
+      ensure(50==singles);
+      ensure(50==masters);
+      ensure(vector<size_t>(3,50)==seen);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("exception breaks the barriers");
+
+      worker_team team {3};
+      try
+      {
+         team.parallel_region(3, [](team_ctx& ctx) {
+            for(size_t k = 0; k < 10; ++k)
+            {
+               if(1==ctx.thread_num() && 5==k)
+                  throw invalid_argument("iteration #5 has failed");
+               ctx.barrier();
+            }
+         });
+         ensure(!"this line is not reachable");
+      }
+      catch(const invalid_argument& e)
+      {
+         ensure(string("iteration #5 has failed")==e.what());
+      }
+
+         // the team is reusable
+      atomic<size_t> count {0};
+      team.parallel_region(3, [&](team_ctx& ctx) { ctx.barrier(); ++count; });
+      ensure(3==count);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<5>()
+   {
+      set_test_name("nested region & global team");
+
+      atomic<size_t> inner {0};
+      worker_team team {2};
+      team.parallel_region(2, [&](team_ctx&) {
+         team.parallel_region(2, [&](team_ctx& nested) {
+            ensure(1==nested.team_size());
+            nested.barrier();
+            ++inner;
+         });
+      });
+      ensure(2==inner);
+
+      ensure(thread_ex::available_concurrency()==worker_team::global().size());
+      atomic<size_t> count {0};
+      thread_ex::parallel_region(2, [&](team_ctx& ctx) { ctx.barrier(); ++count; });
+      ensure(min<size_t>(2,worker_team::global().size())==count);
+   }
+
+} // namespace tut
@@ -0,0 +1,164 @@
+#include <te_parallel_scan.h>
+#include "te_compiler_warning_suppress.h"
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("parallel_scan");
+
+   using thread_ex::parallel_inclusive_scan;
+   using thread_ex::parallel_exclusive_scan;
+   using thread_ex::thread_pool;
+   using namespace std;
+
+   const size_t sizes[]  = {0, 1, 2, 7, 100, 1000, 100003};
+   const size_t blocks[] = {0, 1, 2, 3, 7, 1000000};   // 0 - by runtime_concurrency, the last one is more than elements
+
+   vector<uint64_t> sequence(size_t n)
+   {
+      vector<uint64_t> v(n);
+      for(size_t i=0; i<n; ++i)
+         v[i] = (i*7919) % 1013;
+      return v;
+   }
+
+   template <typename T, typename BinaryOp>
+   vector<T> exclusive_reference(const vector<T>& in, T init, BinaryOp op)
+   {
+      vector<T> out;
+      out.reserve(in.size());
+      for(const auto& x : in)
+      {
+         out.push_back(init);
+         init = op(init, x);
+      }
+      return out;
+   }
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("inclusive scan vs. partial_sum");
+
+      thread_pool tp {3};
+
+      for(size_t n : sizes)
+         for(size_t b : blocks)
+         {
+            const auto in = sequence(n);
+            vector<uint64_t> expected(n);
+            partial_sum(in.begin(), in.end(), expected.begin());
+
+            vector<uint64_t> out(n, 0);
+            ensure(out.end()==parallel_inclusive_scan(tp, in.begin(), in.end(), out.begin(), plus<>{}, b));
+            ensure(expected==out);
+
+            auto inplace = in;
+            parallel_inclusive_scan(tp, inplace.begin(), inplace.end(), inplace.begin(), plus<>{}, b);
+            ensure(expected==inplace);
+         }
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("exclusive scan");
+
+      thread_pool tp {3};
+
+      for(size_t n : sizes)
+         for(size_t b : blocks)
+         {
+            const auto in = sequence(n);
+            const auto expected = exclusive_reference(in, uint64_t{42}, plus<>{});
+
+            vector<uint64_t> out(n, 0);
+            ensure(out.end()==parallel_exclusive_scan(tp, in.begin(), in.end(), out.begin(), uint64_t{42}, plus<>{}, b));
+            ensure(expected==out);
+
+            auto inplace = in;
+            parallel_exclusive_scan(tp, inplace.begin(), inplace.end(), inplace.begin(), uint64_t{42}, plus<>{}, b);
+            ensure(expected==inplace);
+         }
+
+         // the default pool
+      const auto in = sequence(50000);
+      vector<uint64_t> out(in.size());
+      parallel_exclusive_scan(in.begin(), in.end(), out.begin(), uint64_t{0});
+      ensure(exclusive_reference(in, uint64_t{0}, plus<>{})==out);
+      parallel_inclusive_scan(in.begin(), in.end(), out.begin());
+      ensure(accumulate(in.begin(), in.end(), uint64_t{0})==out.back());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("associative, not commutative operation");
+
+      thread_pool tp {2};
+
+      vector<string> in;
+      for(size_t i=0; i<200; ++i)
+         in.push_back(string(1, static_cast<char>('a' + i % 26)));
+      auto concat = [](const string& l, const string& r) { return l + r; };
+
+      vector<string> expected(in.size());
+      partial_sum(in.begin(), in.end(), expected.begin(), concat);
+      for(size_t b : {1, 2, 5, 13})
+      {
+         vector<string> out(in.size());
+         parallel_inclusive_scan(tp, in.begin(), in.end(), out.begin(), concat, b);
+         ensure(expected==out);
+
+         parallel_exclusive_scan(tp, in.begin(), in.end(), out.begin(), string{">"}, concat, b);
+         ensure(exclusive_reference(in, string{">"}, concat)==out);
+      }
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("an exception of the operation");
+
+      thread_pool tp {2};
+
+      const auto in = sequence(10000);
+      vector<uint64_t> out(in.size());
+      auto throwing = [](uint64_t l, uint64_t r) -> uint64_t {
+         if(1012==r)
+            throw runtime_error("1012");
+         return l + r;
+      };
+      for(size_t b : {1, 4})
+         try
+         {
+            parallel_inclusive_scan(tp, in.begin(), in.end(), out.begin(), throwing, b);
+            ensure(!"this line is not reachable");
+         }
+         catch(const runtime_error& e)
+         {
+            ensure(string{"1012"}==e.what());
+         }
+      ensure(7==tp.submit([] { return 7; }).get());   // the pool is alive
+   }
+
+} // namespace tut
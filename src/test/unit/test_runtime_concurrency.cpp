@@ -13,7 +13,7 @@ struct data
    data(const data&) = delete;
    data& operator=(const data&) = delete;
 
-   const size_t hardware_processors = std::thread::hardware_concurrency();
+   const size_t hardware_processors = thread_ex::available_concurrency();
 
 };
 using test_group = tut::test_group<data>;
@@ -0,0 +1,170 @@
+#include <te_stop_token.h>
+#include <te_thread_unjoinable.h>
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("stop_token");
+
+   using thread_ex::stop_source;
+   using thread_ex::stop_token;
+   using thread_ex::stop_callback;
+   using thread_ex::stoppable_thread;
+   using std::atomic;            // no 'using namespace std', std::stop_token & std::stop_source of C++20 are ambiguous with these ones
+   using std::string;
+   using std::thread;
+   using std::vector;
+   using std::make_unique;
+   namespace this_thread = std::this_thread;
+   using namespace std::chrono_literals;
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("source & token");
+
+      stop_token none;
+      ensure(!none.stop_possible());
+      ensure(!none.stop_requested());
+
+      stop_token t;
+      {
+         stop_source s;
+         t = s.get_token();
+         ensure(t.stop_possible());
+         ensure(!t.stop_requested());
+
+         stop_source copy {s};
+         ensure(t==copy.get_token());
+         ensure(copy.request_stop());
+         ensure(!s.request_stop());    // requested by the copy
+         ensure(s.stop_requested());
+         ensure(t.stop_requested());
+      }
+      ensure(t.stop_possible());       // the stop has been requested
+
+      stop_token orphan;
+      {
+         stop_source s;
+         orphan = s.get_token();
+      }
+      ensure(!orphan.stop_possible());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("callbacks");
+
+      stop_source s;
+      vector<string> calls;
+      {
+         auto first  = [&calls] { calls.push_back("first"); };
+         auto second = [&calls] { calls.push_back("second"); };
+         auto gone   = [&calls] { calls.push_back("gone"); };
+         stop_callback<decltype(first)>   c1 {s.get_token(), first};
+         stop_callback<decltype(second)>  c2 {s.get_token(), second};
+         {
+            stop_callback<decltype(gone)> c3 {s.get_token(), gone};
+         }
+         ensure(calls.empty());
+         s.request_stop();
+         ensure((vector<string>{"first","second"})==calls);
+         s.request_stop();
+         ensure(2==calls.size());
+
+         auto late = [&calls] { calls.push_back("late"); };
+         stop_callback<decltype(late)> c4 {s.get_token(), late};   // at once
+         ensure("late"==calls.back());
+      }
+
+      size_t never {0};
+      auto count = [&never] { ++never; };
+      stop_callback<decltype(count)> c5 {stop_token{}, count};
+      ensure(0==never);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("destructor waits for a running callback");
+
+      stop_source s;
+      atomic<bool> entered {false};
+      atomic<bool> finished {false};
+      auto slow = [&] { entered = true; this_thread::sleep_for(50ms); finished = true; };
+      auto cb = make_unique<stop_callback<decltype(slow)>>(s.get_token(), slow);
+      thread stopper {[&s] { s.request_stop(); }};
+      while(!entered)
+         this_thread::yield();
+      cb.reset();
+      ensure(finished==true);
+      stopper.join();
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("stoppable thread");
+
+      atomic<size_t> loops {0};
+      {
+         stoppable_thread t {[&loops](stop_token token, size_t step) {
+            while(!token.stop_requested())
+            {
+               loops += step;
+               this_thread::sleep_for(1ms);
+            }
+         }, size_t(2)};
+         ensure(t.joinable());
+         while(0==loops)
+            this_thread::yield();
+      }  // stopped and joined
+      const size_t after = loops;
+      ensure(0==after%2);
+      this_thread::sleep_for(10ms);
+      ensure(after==loops);
+
+         // a function without a token
+      size_t done {0};
+      {
+         stoppable_thread t {[&done] { done = 1; }};
+      }
+      ensure(1==done);
+
+      stoppable_thread a {[](stop_token token) { while(!token.stop_requested()) this_thread::sleep_for(1ms); }};
+      stoppable_thread b {std::move(a)};
+      ensure(!a.joinable());
+      ensure(b.get_stop_token().stop_possible());
+      ensure(b.request_stop());
+      b.join();
+      ensure(!b.joinable());
+
+         // no thread, no stop state
+      stoppable_thread empty;
+      ensure(!empty.joinable());
+      ensure(!empty.get_stop_token().stop_possible());
+      ensure(!empty.request_stop());
+      ensure(!stop_source{thread_ex::nostopstate}.get_token().stop_possible());
+   }
+
+} // namespace tut
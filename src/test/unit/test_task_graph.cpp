@@ -0,0 +1,159 @@
+#include <te_task_graph.h>
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("task_graph");
+
+   using thread_ex::task_graph;
+   using thread_ex::thread_pool;
+   using namespace std;
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("dependencies are respected");
+
+      thread_pool tp {4};
+
+         // a diamond: a -> (b, c) -> d, every node records its finishing order
+      atomic<size_t> clock {0};
+      vector<size_t> at(4, 0);
+      task_graph g;
+      const auto a = g.add([&] { at[0] = ++clock; });
+      const auto b = g.add([&] { at[1] = ++clock; });
+      const auto c = g.add([&] { at[2] = ++clock; });
+      const auto d = g.add([&] { at[3] = ++clock; });
+      g.precede(a,b);
+      g.precede(a,c);
+      g.precede(b,d);
+      g.precede(c,d);
+      ensure(4==g.size());
+
+      for(size_t run=0; run<50; ++run)   // declared once, run many times
+      {
+         clock = 0;
+         g.run(tp);
+         ensure(1==at[0]);
+         ensure(at[1] > at[0] && at[2] > at[0]);
+         ensure(4==at[3]);
+      }
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("a wide & deep graph");
+
+      thread_pool tp {3};
+
+         // layers of nodes, a node depends on two nodes of the previous layer and sums their values
+      constexpr size_t layers = 20;
+      constexpr size_t width  = 50;
+      vector<vector<size_t>> value(layers, vector<size_t>(width, 0));
+      task_graph g;
+      vector<vector<task_graph::node_id>> ids(layers);
+      for(size_t l=0; l<layers; ++l)
+         for(size_t i=0; i<width; ++i)
+         {
+            ids[l].push_back(g.add([&value,l,i] {
+               value[l][i] = 0==l? 1 : value[l-1][i] + value[l-1][(i+1)%width];
+            }));
+            if(l)
+            {
+               g.precede(ids[l-1][i], ids[l].back());
+               g.precede(ids[l-1][(i+1)%width], ids[l].back());
+            }
+         }
+      g.run(tp);
+      for(size_t i=0; i<width; ++i)
+         ensure(size_t(1) << (layers-1) == value[layers-1][i]);
+
+      task_graph empty;
+      empty.run(tp);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("errors");
+
+      thread_pool tp {2};
+
+      task_graph g;
+      atomic<size_t> after {0};
+      const auto a = g.add([] { throw invalid_argument("node a"); });
+      const auto b = g.add([&after] { ++after; });
+      g.precede(a,b);
+      try
+      {
+         g.run(tp);
+         ensure(!"this line is not reachable");
+      }
+      catch(const invalid_argument& e)
+      {
+         ensure(string("node a")==e.what());
+      }
+      ensure(0==after);    // the successor is skipped
+
+      try
+      {
+         g.precede(a,7);
+         ensure(!"this line is not reachable");
+      }
+      catch(const out_of_range&)
+      {
+      }
+
+      task_graph cycle;
+      const auto x = cycle.add([] {});
+      const auto y = cycle.add([] {});
+      cycle.precede(x,y);
+      cycle.precede(y,x);
+      try
+      {
+         cycle.run(tp);
+         ensure(!"this line is not reachable");
+      }
+      catch(const logic_error&)
+      {
+      }
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("run by a worker of the same pool");
+
+      thread_pool tp {1};
+
+      task_graph g;
+      atomic<size_t> count {0};
+      const auto a = g.add([&count] { ++count; });
+      g.precede(a, g.add([&count] { ++count; }));
+         // the only worker waits for the graph, a compensating worker runs its nodes
+      tp.submit([&g,&tp] { g.run(tp); }).get();
+      ensure(2==count);
+   }
+
+} // namespace tut
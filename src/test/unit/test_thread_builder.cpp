@@ -0,0 +1,154 @@
+#include <te_thread_builder.h>
+#include <te_thread_pool.h>
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <string>
+#include <set>
+#include <system_error>
+#ifdef __linux__
+   #include <pthread.h>
+   #include <sched.h>
+#endif
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("thread_builder");
+
+   using thread_ex::thread_builder;
+   using thread_ex::native_thread;
+   using thread_ex::sched_policy;
+   using namespace std;
+
+#ifdef __linux__
+   string current_name()
+   {
+      char name[16] {};
+      pthread_getname_np(pthread_self(), name, sizeof(name));
+      return name;
+   }
+
+   size_t current_stack_size()
+   {
+      pthread_attr_t attr;
+      size_t size {0};
+      if(0==pthread_getattr_np(pthread_self(), &attr))
+      {
+         pthread_attr_getstacksize(&attr, &size);
+         pthread_attr_destroy(&attr);
+      }
+      return size;
+   }
+#endif
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("spawn & join");
+
+      int sum {0};
+      native_thread t = thread_builder{}.spawn([&sum](int a, int b) { sum = a+b; }, 2, 3);
+      ensure(t.joinable());
+      t.join();
+      ensure(!t.joinable());
+      ensure(5==sum);
+
+      try
+      {
+         t.join();
+         ensure(!"this line is not reachable");
+      }
+      catch(const system_error& e)
+      {
+         ensure(make_error_code(errc::invalid_argument)==e.code());
+      }
+
+      atomic<bool> done {false};
+      {
+         thread_ex::joined_native_thread j = thread_builder{}.spawn([&done] { done = true; });
+      }
+      ensure(done==true);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("stack size & name");
+
+      thread_builder b;
+      b.stack_size(256*1024).name("te-builder-test-long-name");
+      ensure(256*1024==b.stack_size());
+      ensure("te-builder-test-long-name/3"==b.indexed(3).name());
+      ensure(thread_builder{}.indexed(3).name().empty());
+
+#ifdef __linux__
+      size_t stack {0};
+      string name;
+      b.spawn([&] { stack = current_stack_size(); name = current_name(); }).join();
+      ensure(256*1024==stack);
+      ensure("te-builder-test"==name);   // 15 characters
+
+         // a tiny stack is rounded up to the minimum
+      b.stack_size(1).spawn([&] { stack = current_stack_size(); }).join();
+      ensure(stack >= static_cast<size_t>(PTHREAD_STACK_MIN));
+#endif
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("scheduling policy");
+
+#ifdef __linux__
+      int policy {-1};
+      thread_builder{}.policy(sched_policy::batch).spawn([&policy] { policy = sched_getscheduler(0); }).join();
+      ensure(SCHED_BATCH==policy);
+      thread_builder{}.policy(sched_policy::idle).spawn([&policy] { policy = sched_getscheduler(0); }).join();
+      ensure(SCHED_IDLE==policy);
+#endif
+         // an invalid priority for the policy: the thread is not started
+      try
+      {
+         thread_builder{}.policy(sched_policy::other, 50).spawn([] {}).join();
+         ensure(!"this line is not reachable");
+      }
+      catch(const system_error&)
+      {
+      }
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("named workers of thread_pool");
+
+      thread_ex::thread_pool tp {thread_ex::thread_pool::deferred_start_type{}};
+      tp.start(2, thread_builder{}.name("pool").stack_size(512*1024));
+      ensure(2==tp.thread_count());
+#ifdef __linux__
+      set<string> names;
+      for(size_t i=0; i<200 && names.size()<2; ++i)
+      {
+         const string n = tp.submit([] { this_thread::sleep_for(chrono::milliseconds(1)); return current_name(); }).get();
+         ensure("pool/0"==n || "pool/1"==n);
+         names.insert(n);
+      }
+      ensure(512*1024==tp.submit(current_stack_size).get());
+#endif
+   }
+
+} // namespace tut
@@ -0,0 +1,120 @@
+#include <te_thread_cache.h>
+#include <te_async.h>
+#include <te_thread_pool.h>
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <set>
+#include <vector>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("thread_cache");
+
+   using thread_ex::thread_cache;
+   using namespace std;
+   using namespace std::chrono_literals;
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("threads are reused");
+
+      thread_cache cache;
+      ensure(0==cache.size());
+
+      set<thread::id> ids;
+      for(size_t i=0; i<20; ++i)
+      {
+         promise<thread::id> p;
+         auto f = p.get_future();
+         cache.execute([&p] { p.set_value(this_thread::get_id()); });
+         ids.insert(f.get());
+         while(1!=cache.idle())  // the thread is back to the cache
+            this_thread::yield();
+      }
+      ensure(1==ids.size());
+      ensure(1==cache.size());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("every call runs concurrently");
+
+         // every call waits for all the others, a queue of pending calls would be a deadlock
+      constexpr size_t N = 8;
+      thread_cache cache;
+      atomic<size_t> arrived {0};
+      vector<future<void>> results;
+      for(size_t i=0; i<N; ++i)
+      {
+         auto p = make_shared<promise<void>>();
+         results.push_back(p->get_future());
+         cache.execute([p,&arrived] {
+            ++arrived;
+            while(N!=arrived)
+               this_thread::yield();
+            p->set_value();
+         });
+      }
+      for(auto& r : results)
+         ensure(future_status::ready==r.wait_for(5s));
+      ensure(N==cache.size());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("idle threads exit after keep-alive");
+
+      thread_cache cache {20ms};
+      promise<void> p;
+      cache.execute([&p] { p.set_value(); });
+      p.get_future().get();
+      for(size_t i=0; i<500 && cache.size(); ++i)
+         this_thread::sleep_for(10ms);
+      ensure(0==cache.size());
+
+      promise<int> again;
+      cache.execute([&again] { again.set_value(7); });
+      ensure(7==again.get_future().get());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("call_async on the default cache");
+
+      auto f = thread_ex::call_async(thread_ex::pooled, [](int a, int b) { return a+b; }, 2, 3);
+      ensure(5==f.get());
+
+         // the same rendezvous as std::async based call_async guarantees
+      promise<void> ping;
+      auto pong = thread_ex::call_async(thread_ex::pooled, [&ping] { ping.get_future().get(); return 1; });
+      auto f2   = thread_ex::call_async(thread_ex::pooled, [&ping] { ping.set_value(); return 2; });
+      ensure(1==pong.get());
+      ensure(2==f2.get());
+
+      ensure(&thread_ex::default_thread_cache()==&thread_ex::default_thread_cache());
+      ensure(&thread_ex::default_thread_pool()==&thread_ex::default_thread_pool());
+      ensure(4==thread_ex::default_thread_pool().submit([] { return 4; }).get());
+   }
+
+} // namespace tut
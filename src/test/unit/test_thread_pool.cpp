@@ -1,8 +1,10 @@
 #include "tut.h"
+#include "test_helpers.h"
 #include <te_thread_pool.h>
 #include <te_block_lock.h>
 #include <chrono>
 #include <map>
+#include <set>
 #include <numeric>
 #include <iterator>
 
@@ -19,6 +21,7 @@ namespace
    using namespace thread_ex::block;
    using namespace std;
    using namespace std::chrono_literals;
+   using test_helpers::eventually;
 
 } // end of anonymous namespace
 
@@ -40,7 +43,7 @@ namespace tut
       });};
 
       {  thread_pool tp;   
-         ensure( std::thread::hardware_concurrency()==tp.thread_count());
+         ensure( thread_ex::available_concurrency()==tp.thread_count());
 
          for(size_t i=0; i < SUBMISSIONS; ++i)
             tp.submit(std::ref(l));    // returned future is ignored, it's ok . This behavious conforms to std::future<> returned by std::packaged_task
@@ -72,7 +75,7 @@ namespace tut
       });};
 
       {  thread_pool tp;   
-         ensure( std::thread::hardware_concurrency()==tp.thread_count());
+         ensure( thread_ex::available_concurrency()==tp.thread_count());
 
          for(size_t i=0; i < SUBMISSIONS; ++i)
             tp.submit(std::ref(l));
@@ -230,5 +233,269 @@ namespace tut
       ensure(sum==N*(N+1)/2);
    }
 
+   template<>
+   template<>
+   void test_instance::test<6>()
+   {
+      set_test_name ("the same key, the same worker");
+
+      thread_pool tp{4};
+      this_thread::sleep_for(50ms);   // all the workers are parked
+
+      auto id = [] { return this_thread::get_id(); };
+      set<thread::id> ids;
+      for(size_t i=0; i < 100; ++i)
+         ids.insert(tp.submit_with_key(string("shard #7"),id).get());
+      ensure(1==ids.size());
+
+      vector<future<size_t>> results;
+      for(size_t i=0; i < 1000; ++i)
+         results.push_back(tp.submit_with_key(i%10,[](size_t v) { return v*2; },i));
+      size_t sum = 0;
+      for(auto& r : results)
+         sum += r.get();
+      ensure(999*1000==sum);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<7>()
+   {
+      set_test_name ("idle workers steal the backlog of a key");
+
+      thread_pool tp {4};
+
+      mutex m;
+      set<thread::id> ids;
+      vector<future<void>> results;
+      for(size_t i=0; i < 100; ++i)
+         results.push_back(tp.submit_with_key(13,[&] {
+            this_thread::sleep_for(1ms);
+            lock(m,[&]{ ids.insert(this_thread::get_id()); });
+         }));
+      for(auto& r : results)
+         r.get();
+      ensure(1 < ids.size());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<8>()
+   {
+      set_test_name ("watchdog reports a stalled task once");
+
+      struct stall
+      {
+         string               label;
+         size_t               worker;
+         chrono::milliseconds elapsed;
+      };
+      mutex m;
+      vector<stall> stalls;
+
+      thread_pool tp{2};
+      tp.watch(50ms, [&](const char* label, size_t worker, chrono::milliseconds elapsed) {
+         lock(m,[&]{ stalls.push_back({label,worker,elapsed}); });
+      });
+
+      auto slow = tp.submit(thread_ex::task_options{"slow one"}, [] { this_thread::sleep_for(300ms); });
+      vector<future<void>> fast;
+      for(size_t i=0; i < 100; ++i)
+         fast.push_back(tp.submit(thread_ex::task_options{"fast one"}, [] {}));
+      for(auto& f : fast)
+         f.get();
+      slow.get();
+      tp.stop();
+
+      ensure(1==stalls.size());
+      ensure("slow one"==stalls.front().label);
+      ensure(stalls.front().worker < tp.thread_count());
+      ensure(stalls.front().elapsed >= 50ms);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<9>()
+   {
+      set_test_name ("expired tasks are discarded");
+
+      thread_pool tp{thread_pool::deferred_start_type{}};
+      ensure(0==tp.metrics().discarded);
+
+      thread_ex::task_options expired;
+      expired.deadline = chrono::steady_clock::now() + 10ms;
+      thread_ex::task_options in_time;
+      in_time.deadline = chrono::steady_clock::now() + 1h;
+
+      atomic<size_t> runs {0};
+      auto task = [&runs] { return ++runs; };
+      auto f1 = tp.submit(expired,task);
+      auto f2 = tp.submit(in_time,task);
+      auto f3 = tp.submit(task);
+      ensure(3==tp.metrics().queued);
+
+      this_thread::sleep_for(20ms);
+      tp.start(1);
+      try
+      {
+         f1.get();
+         ensure(!"this line is not reachable");
+      }
+      catch(const thread_ex::expired_error&)
+      {
+      }
+      ensure(1==f2.get());
+      ensure(2==f3.get());
+      ensure(1==tp.metrics().discarded);
+      ensure(0==tp.metrics().queued);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<10>()
+   {
+      set_test_name ("blocked workers are compensated");
+
+      thread_pool tp{thread_pool::deferred_start_type{}};
+      tp.compensate(2);
+      tp.start(2);
+
+      promise<void> gate;
+      shared_future<void> opened = gate.get_future().share();
+      auto blocking = [opened] {
+         thread_ex::blocking_section b;
+         thread_ex::blocking_section nested;
+         opened.wait();
+      };
+      auto f1 = tp.submit(blocking);
+      auto f2 = tp.submit(blocking);
+      ensure(eventually([&] { return 2==tp.metrics().blocked; }));
+      ensure(0 < tp.metrics().compensating);
+
+         // both workers are blocked, the task is run by a compensating one
+      auto cpu = tp.submit([] { return 42; });
+      ensure(future_status::ready==cpu.wait_for(5s));
+      ensure(42==cpu.get());
+
+      gate.set_value();
+      f1.get();
+      f2.get();
+      ensure(0==tp.metrics().blocked);
+      ensure(eventually([&] { return 0==tp.metrics().compensating; }));
+
+      thread_ex::blocking_section out_of_pool;   // does nothing
+      ensure(7==tp.submit([] { return 7; }).get());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<11>()
+   {
+      set_test_name ("CPU time accounting by tag");
+
+      const size_t spin = thread_ex::intern_tag("spin");
+      const size_t nap  = thread_ex::intern_tag("nap");
+      ensure(0 < spin);
+      ensure(spin!=nap);
+      ensure(spin==thread_ex::intern_tag("spin"));
+      ensure("nap"==thread_ex::tag_name(nap));
+
+      thread_pool tp {2};
+      tp.submit([] {}).get();
+      ensure(tp.accounting().empty());   // not accounted by default
+
+      tp.account(true);
+      thread_ex::task_options spinning;
+      spinning.tag = spin;
+      thread_ex::task_options napping;
+      napping.tag = nap;
+
+      vector<future<void>> results;
+      for(size_t i=0; i < 4; ++i)
+      {
+         results.push_back(tp.submit(spinning,[] {
+            const auto until = chrono::steady_clock::now() + 20ms;
+            while(chrono::steady_clock::now() < until);
+         }));
+         results.push_back(tp.submit(napping,[] { this_thread::sleep_for(20ms); }));
+      }
+      results.push_back(tp.submit([] {}));
+      for(auto& r : results)
+         r.get();
+      tp.account(false);
+      tp.submit(spinning,[] {}).get();
+      tp.stop();  // the future is ready before the time of the task is added up, the totals are exact once the workers are joined
+
+      const auto usage = tp.accounting();
+      ensure(3==usage.size());
+      ensure(0==usage[0].tag && 1==usage[0].count);
+      for(const auto& u : usage)
+      {
+         ensure(u.cpu <= u.wall + 10ms);
+         if(spin==u.tag)
+         {
+            ensure("spin"==u.name);
+            ensure(4==u.count);
+            ensure(u.wall >= 80ms);
+         }
+         else if(nap==u.tag)
+         {
+            ensure(4==u.count);
+            ensure(u.wall >= 80ms);
+            ensure(u.cpu < u.wall/2);
+         }
+      }
+   }
+
+   template<>
+   template<>
+   void test_instance::test<12>()
+   {
+      set_test_name ("a task waits for another task, not governed by default");
+
+      thread_pool tp {4};
+      auto outer = tp.submit([&tp] { return tp.submit([] { return 42; }).get(); });
+      ensure(42==outer.get());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<13>()
+   {
+      set_test_name ("the token is taken back when a blocking section is left");
+
+      thread_ex::concurrency_governor g {1};
+      thread_pool tp{thread_pool::deferred_start_type{}};
+      tp.govern(&g);
+      tp.compensate(0);
+      tp.start(1);
+
+      size_t inside {1}, after {1};
+      tp.submit([&] {
+         {  thread_ex::blocking_section b;
+            inside = g.available();
+         }
+         after = g.available();
+      }).get();
+      ensure(1==inside);
+      ensure(0==after);
+      ensure(eventually([&g] { return 1==g.available(); }));    // given back when the worker goes idle
+   }
+
+   template<>
+   template<>
+   void test_instance::test<14>()
+   {
+      set_test_name ("post runs without a future");
+
+      thread_pool tp {2};
+
+      atomic<size_t> count {0};
+      for(size_t i=0; i<100; ++i)
+         tp.post([&count] { ++count; });
+      tp.stop();   // graceful, the posted functions are run
+      ensure(100==count);
+   }
+
 } // namespace tut
 
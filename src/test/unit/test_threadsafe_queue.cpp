@@ -1,6 +1,7 @@
 #include <te_container.h>
 #include <te_move.h>
 #include <te_async.h>
+#include <te_thread_unjoinable.h>
 #include "te_compiler_warning_suppress.h"
 #include <vector>
 #include <algorithm>
@@ -365,4 +366,89 @@ template<>
 
    }
 
+   template<>
+   template<>
+   void test_intance::test<11>()
+   {
+      set_test_name("batch of elements");
+
+      threadsafe_queue<int> q;
+      for (int i = 0; i<10; ++i)
+         q.push(i);
+
+      threadsafe_queue<int>::container_type out;
+      ensure(4 == q.try_pop(std::nothrow, out, 4));
+      ensure(out == std::queue<int>({0,1,2,3}));
+      ensure(6 == q.size());
+
+         // a fair share: no more than 1/4 of 6 elements (rounded up)
+      ensure(2 == q.try_pop(std::nothrow, out, 100, 4));
+      ensure(out == std::queue<int>({0,1,2,3,4,5}));
+
+      ensure(4 == q.wait_pop(out, 100));
+      ensure(out == std::queue<int>({0,1,2,3,4,5,6,7,8,9}));
+      ensure(q.empty());
+      ensure(0 == q.try_pop(std::nothrow, out, 100));
+   }
+
+   template<>
+   template<>
+   void test_intance::test<12>()
+   {
+      set_test_name("batch waits for the first element");
+
+      threadsafe_queue<std::string> q;
+      std::future<size_t> result = call_async([&q] {
+            threadsafe_queue<std::string>::container_type out;
+            return q.wait_pop(out, 10);
+         }
+      );
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      q.push("first");
+      ensure(1 == result.get());
+   }
+
+   template<>
+   template<>
+   void test_intance::test<13>()
+   {
+      set_test_name("wait interrupted by a stop request");
+
+      threadsafe_queue<int> q;
+      std::vector<int> consumed;
+      {  // no poison pill: the consumer is stopped by the destructor of the thread
+         thread_ex::stoppable_thread consumer {[&q,&consumed](thread_ex::stop_token token) {
+               int v {0};
+               while (q.wait_pop(v, token))
+                  consumed.push_back(v);
+            }
+         };
+         for (int i = 0; i<5; ++i)
+            q.push(i);
+         while (!q.empty())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      ensure(consumed == std::vector<int>({0,1,2,3,4}));
+
+      thread_ex::stop_source s;
+      std::future<size_t> batch = call_async([&q,&s] {
+            threadsafe_queue<int>::container_type out;
+            return q.wait_pop(out, 10, 1, s.get_token());
+         }
+      );
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      s.request_stop();
+      ensure(0 == batch.get());
+
+         // the elements are popped while there are some
+      q.push(7);
+      threadsafe_queue<int>::container_type all;
+      ensure(q.wait_pop(all, s.get_token()));
+      ensure(all == std::queue<int>({7}));
+      int v {0};
+      ensure(!q.wait_pop(v, s.get_token()));
+   }
+
 } // namespace 'tut'
@@ -1,4 +1,5 @@
 #include <te_sequence.h>
+#include <te_parallel_find.h>
 #include "te_async.h"
 #include "te_compiler_warning_suppress.h"
 #include <vector>
@@ -407,4 +408,24 @@ namespace tut
       ensure(100==destination.size());
    }
 
+   template<>
+   template<>
+   void test_intance::test<11>()
+   {
+      using thread_ex::find_first;
+      thread_ex::thread_pool tp {2};
+
+      vector<int> content(200000);
+      iota(content.begin(), content.end(), 0);
+      threadsafe_vector v(std::move(content));
+      ensure(make_pair(true,150001)==find_first(v, tp, [](int i) { return i > 150000; }));
+      ensure(make_pair(true,3)==find_first(v, tp, [](int i) { return 0==i%3 && i; }));
+      ensure(make_pair(false,0)==find_first(v, tp, [](int i) { return i < 0; }));
+
+      thread_ex::threadsafe_list<int> l;
+      l.push_back(1);
+      l.push_back(2);
+      ensure(make_pair(true,2)==find_first(l, tp, [](int i) { return 0==i%2; }));
+   }
+
 } // namespace 'tut'
@@ -0,0 +1,199 @@
+#include <te_topology.h>
+#include "te_compiler_warning_suppress.h"
+#include <string>
+#include <vector>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+#include "test_helpers.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("topology");
+
+   using thread_ex::cpu_topology;
+   using namespace std;
+
+   using cpus = vector<size_t>;
+
+#ifndef _WIN32
+      // a fake sysfs, removed by the destructor
+   struct sysfs_fixture : test_helpers::temp_directory
+   {
+      sysfs_fixture() : temp_directory("/tmp/te_sysfs_") {}
+
+      void cpu(size_t n, size_t package, size_t core)
+      {
+         const string dir = "/devices/system/cpu/cpu" + to_string(n);
+         write(dir + "/topology/physical_package_id", to_string(package));
+         write(dir + "/topology/core_id", to_string(core));
+      }
+      void cache(size_t n, size_t index, size_t level, const string& type, const string& size, const string& shared)
+      {
+         const string dir = "/devices/system/cpu/cpu" + to_string(n) + "/cache/index" + to_string(index);
+         write(dir + "/level", to_string(level));
+         write(dir + "/type", type);
+         write(dir + "/size", size);
+         write(dir + "/shared_cpu_list", shared);
+      }
+   };
+#endif
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+#ifndef _WIN32
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("two packages, two NUMA nodes, SMT");
+
+         // cpu i and i+4 are SMT siblings, package 0 is {0,1,4,5}
+      sysfs_fixture f;
+      f.write("/devices/system/cpu/online", "0-7");
+      f.write("/devices/system/node/online", "0-1");
+      f.write("/devices/system/node/node0/cpulist", "0-1,4-5");
+      f.write("/devices/system/node/node1/cpulist", "2-3,6-7");
+      for(size_t n = 0; n < 8; ++n)
+      {
+         const size_t package = (n%4)/2, core = n%2;
+         f.cpu(n, package, core);
+         const string siblings = to_string(n%4) + "," + to_string(n%4 + 4);
+         f.cache(n, 0, 1, "Data", "32K", siblings);
+         f.cache(n, 1, 1, "Instruction", "32K", siblings);
+         f.cache(n, 2, 2, "Unified", "1024K", siblings);
+         f.cache(n, 3, 3, "Unified", "16384K", 0==package? "0-1,4-5" : "2-3,6-7");
+      }
+
+      const cpu_topology t {f.root};
+      ensure(t.discovered());
+      ensure(8==t.cpu_count());
+      ensure(4==t.core_count());
+      ensure(2==t.node_count());
+      ensure(2==t.domain_count());
+
+      ensure(2==t.packages().size());
+      const auto& p1 = t.packages()[1];
+      ensure(1==p1.id);
+      ensure((cpus{2,3,6,7})==p1.cpus);
+      ensure(1==p1.nodes.size());
+      ensure(1==p1.nodes[0].id);
+      ensure(1==p1.nodes[0].domains.size());
+      const auto& l3 = p1.nodes[0].domains[0];
+      ensure(3==l3.level);
+      ensure(16384*1024==l3.size);
+      ensure((cpus{2,3,6,7})==l3.shared);
+      ensure(2==l3.cores.size());
+      ensure((cpus{2,6})==l3.cores[0].cpus);
+      ensure((cpus{3,7})==l3.cores[1].cpus);
+
+      ensure(4*3 + 2==t.caches().size());    // L1d, L1i and L2 per core, L3 per package
+      ensure(1==t.caches().front().level);
+      ensure(3==t.caches().back().level);
+      const auto l2 = t.cpu_groups(2);
+      ensure(4==l2.size());
+      ensure((cpus{0,4})==l2[0]);
+      ensure(4==t.cpu_groups(1).size());     // the instruction caches are not counted
+      ensure(t.cpu_groups(4).empty());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("L3 domains within a node, a cache shared by nodes");
+
+      {  sysfs_fixture f;           // two L3 (CCX) of 4 cores in one package and node, no NUMA information
+         f.write("/devices/system/cpu/online", "0-7");
+         for(size_t n = 0; n < 8; ++n)
+         {
+            f.cpu(n, 0, n);
+            f.cache(n, 0, 2, "Unified", "512K", to_string(n));
+            f.cache(n, 1, 3, "Unified", "32M", n < 4? "0-3" : "4-7");
+         }
+         const cpu_topology t {f.root};
+         ensure(1==t.packages().size());
+         ensure(1==t.node_count());
+         ensure(2==t.domain_count());
+         const auto& domains = t.packages()[0].nodes[0].domains;
+         ensure(2==domains.size());
+         ensure(4==domains[1].id);
+         ensure(32u<<20==domains[1].size);
+         ensure((cpus{4,5,6,7})==domains[1].cpus);
+         ensure(4==domains[1].cores.size());
+      }
+      {  sysfs_fixture f;           // sub-NUMA clustering: one L3 of two nodes
+         f.write("/devices/system/cpu/online", "0-3");
+         f.write("/devices/system/node/online", "0-1");
+         f.write("/devices/system/node/node0/cpulist", "0-1");
+         f.write("/devices/system/node/node1/cpulist", "2-3");
+         for(size_t n = 0; n < 4; ++n)
+         {
+            f.cpu(n, 0, n);
+            f.cache(n, 0, 3, "Unified", "8M", "0-3");
+         }
+         const cpu_topology t {f.root};
+         ensure(2==t.node_count());
+         ensure(1==t.domain_count());
+         const auto& nodes = t.packages()[0].nodes;
+         ensure(2==nodes.size());
+         ensure((cpus{2,3})==nodes[1].domains[0].cpus);
+         ensure((cpus{0,1,2,3})==nodes[1].domains[0].shared);
+         ensure(nodes[0].domains[0].id==nodes[1].domains[0].id);
+      }
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("missing information");
+
+      {  sysfs_fixture f;           // no caches, no topology files: a node is a domain, a CPU is a core
+         f.write("/devices/system/cpu/online", "0-2");
+         const cpu_topology t {f.root};
+         ensure(t.discovered());
+         ensure(3==t.cpu_count());
+         ensure(3==t.core_count());
+         ensure(1==t.domain_count());
+         ensure(0==t.packages()[0].nodes[0].domains[0].level);
+         ensure(t.caches().empty());
+      }
+      {  sysfs_fixture f;           // no sysfs at all
+         const cpu_topology t {f.root};
+         ensure(!t.discovered());
+         ensure(max(1u, thread::hardware_concurrency())==t.cpu_count());
+         ensure(t.cpu_count()==t.core_count());
+         ensure(1==t.node_count());
+      }
+   }
+#endif // _WIN32
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("this machine");
+
+      const cpu_topology& t = cpu_topology::system();
+      ensure(&t==&cpu_topology::system());
+      ensure(t.cpu_count() >= 1);
+      ensure(t.core_count() >= 1 && t.core_count() <= t.cpu_count());
+      ensure(t.domain_count() >= 1);
+
+      size_t total {0};
+      for(const auto& p : t.packages())
+         for(const auto& n : p.nodes)
+            for(const auto& d : n.domains)
+               for(const auto& c : d.cores)
+                  total += c.cpus.size();
+      ensure(t.cpu_count()==total);
+   }
+
+} // namespace tut
@@ -0,0 +1,157 @@
+#include <te_typed_thread_pool.h>
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("typed_thread_pool");
+
+   using thread_ex::typed_thread_pool;
+   using namespace std;
+
+   struct record
+   {
+      size_t value  {0};
+      size_t result {0};
+   };
+
+   atomic<size_t> processed_sum {0};
+
+   void process(record& r)
+   {
+      r.result = r.value * 2;
+      processed_sum += r.result;
+   }
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("plain function, one by one");
+
+      processed_sum = 0;
+      constexpr size_t N = 100000;
+      {
+         typed_thread_pool<record> tp {process};
+         for(size_t i=1; i<=N; ++i)
+            tp.submit(record{i,0});
+         tp.wait();
+         ensure(N*(N+1)==processed_sum);
+      }
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("lambda, bulk submission");
+
+      atomic<size_t> sum {0};
+      auto f = [&sum](const size_t& v) { sum += v; };
+
+      vector<size_t> v(10000);
+      iota(begin(v), end(v), 1u);
+
+      typed_thread_pool<size_t,decltype(f)> tp {f, 3};
+      ensure(3==tp.thread_count());
+      tp.submit(begin(v), end(v));
+      tp.submit(begin(v), end(v));
+      tp.wait();
+      ensure(2*v.size()*(v.size()+1)/2==sum);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("graceful exit by default");
+
+      atomic<size_t> counter {0};
+      auto f = [&counter](int&) { ++counter; };
+      {
+         typed_thread_pool<int,decltype(f)> tp {f};
+         for(int i=0; i<10000; ++i)
+            tp.submit(i);
+      }  // <-- behalf of destructor, stop() will be invoked
+      ensure(10000==counter);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("exception handling");
+
+      auto f = [](const int& v) {
+         if(13==v)
+            throw invalid_argument("13 is not allowed");
+      };
+
+      typed_thread_pool<int,decltype(f)> tp {f, 2};
+      for(int i=0; i<100; ++i)
+         tp.submit(i);
+      try
+      {
+         tp.wait();
+         ensure(!"this line is not reachable");
+      }
+      catch(const invalid_argument& e)
+      {
+         ensure(string("13 is not allowed")==e.what());
+      }
+
+         // the error is reported once
+      tp.submit(1);
+      tp.wait();
+   }
+
+   template<>
+   template<>
+   void test_instance::test<5>()
+   {
+      set_test_name("type of task is only moveable");
+
+      atomic<int> sum {0};
+      auto f = [&sum](unique_ptr<int>& p) { sum += *p; };
+
+      typed_thread_pool<unique_ptr<int>,decltype(f)> tp {f};
+      for(int i=1; i<=100; ++i)
+         tp.submit(make_unique<int>(i));
+      tp.wait();
+      ensure(5050==sum);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<6>()
+   {
+      set_test_name("the function type deduced by make_typed_thread_pool");
+
+      atomic<size_t> sum {0};
+      auto tp = thread_ex::make_typed_thread_pool<size_t>([&sum](size_t& v) { sum += v; }, 2);
+      static_assert(!is_pointer<typename decltype(tp)::element_type::function_type>::value, "a lambda, called directly");
+      ensure(2==tp->thread_count());
+      for(size_t i=1; i<=100; ++i)
+         tp->submit(i);
+      tp->wait();
+      ensure(5050==sum);
+   }
+
+} // namespace tut
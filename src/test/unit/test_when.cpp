@@ -0,0 +1,241 @@
+#include <te_when.h>
+#include <te_thread_pool.h>
+#include <te_async.h>
+#include "te_compiler_warning_suppress.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "te_compiler_warning_rollback.h"
+#include "tut.h"
+
+namespace
+{
+   struct data {};
+   using test_group     = tut::test_group<data>;
+   using test_instance  = test_group::object;
+   test_group tg("when_all & when_any");
+
+   using thread_ex::thread_pool;
+   using thread_ex::observable_future;
+   using namespace std;
+   using namespace std::chrono_literals;
+
+} // end of anonymous namespace
+
+
+namespace tut
+{
+
+   template<>
+   template<>
+   void test_instance::test<1>()
+   {
+      set_test_name("on_ready");
+
+      thread_pool tp {1};
+
+      promise<void> gate;
+      auto g = gate.get_future().share();
+      auto f = tp.submit([g] { g.wait(); return 5; });
+      atomic<size_t> calls {0};
+      f.on_ready([&calls] { ++calls; });
+      ensure(0==calls);
+      gate.set_value();
+      ensure(5==f.get());
+      for(size_t i=0; i<500 && 1!=calls; ++i)   // the callback follows the value
+         this_thread::sleep_for(10ms);
+      ensure(1==calls);
+
+         // a ready future calls back at once
+      f = tp.submit([] { return 6; });
+      f.wait();
+      f.on_ready([&calls] { ++calls; });
+      for(size_t i=0; i<500 && 2!=calls; ++i)
+         this_thread::sleep_for(10ms);
+      ensure(2==calls);
+
+      observable_future<int> empty;
+      try
+      {
+         empty.on_ready([] {});
+         ensure(!"this line is not reachable");
+      }
+      catch(const future_error& e)
+      {
+         ensure(future_errc::no_state==e.code());
+      }
+   }
+
+   template<>
+   template<>
+   void test_instance::test<2>()
+   {
+      set_test_name("when_all of a range");
+
+      thread_pool tp {2};
+
+      vector<observable_future<size_t>> futures;
+      for(size_t i=0; i<20; ++i)
+         futures.push_back(tp.submit([i] { this_thread::sleep_for(1ms); return i*i; }));
+
+      auto all = thread_ex::when_all(begin(futures), end(futures));
+      ensure(future_status::ready==all.wait_for(10s));
+      auto done = all.get();
+      ensure(20==done.size());
+      for(size_t i=0; i<done.size(); ++i)
+      {
+         ensure(future_status::ready==done[i].wait_for(0s));
+         ensure(i*i==done[i].get());
+      }
+
+      vector<observable_future<int>> none;
+      ensure(thread_ex::when_all(begin(none), end(none)).get().empty());
+   }
+
+   template<>
+   template<>
+   void test_instance::test<3>()
+   {
+      set_test_name("when_any of a range");
+
+      thread_pool tp {3};
+
+      promise<void> gate;
+      auto g = gate.get_future().share();
+      vector<observable_future<string>> futures;
+      futures.push_back(tp.submit([g] { g.wait(); return string("slow"); }));
+      futures.push_back(tp.submit([] { return string("fast"); }));
+      futures.push_back(tp.submit([g] { g.wait(); return string("slow"); }));
+
+      auto any = thread_ex::when_any(begin(futures), end(futures));
+      ensure(future_status::ready==any.wait_for(10s));
+      auto r = any.get();
+      ensure(1==r.index);
+      ensure("fast"==r.futures[r.index].get());
+      ensure(future_status::timeout==r.futures[0].wait_for(0s));
+      gate.set_value();
+
+      vector<observable_future<int>> none;
+      ensure(size_t(-1)==thread_ex::when_any(begin(none), end(none)).get().index);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<4>()
+   {
+      set_test_name("futures of different types");
+
+      thread_pool tp {2};
+
+      auto all = thread_ex::when_all(
+          tp.submit([] { return 1; })
+         ,thread_ex::call_async(thread_ex::pooled, [] { return string("two"); })
+         ,thread_ex::call_async([] { return 3.0; })   // a plain std::future
+         ,tp.submit([] { throw invalid_argument("four"); })
+      );
+      auto t = all.get();
+      ensure(1==get<0>(t).get());
+      ensure("two"==get<1>(t).get());
+      ensure(3.0==get<2>(t).get());
+      try
+      {
+         get<3>(t).get();
+         ensure(!"this line is not reachable");
+      }
+      catch(const invalid_argument& e)
+      {
+         ensure(string("four")==e.what());
+      }
+
+      promise<void> gate;
+      auto g = gate.get_future().share();
+      auto any = thread_ex::when_any(tp.submit([g] { g.wait(); }), thread_ex::call_async(thread_ex::pooled, [] { return 2; }));
+      auto r = any.get();
+      ensure(1==r.index);
+      ensure(2==get<1>(r.futures).get());
+      gate.set_value();
+   }
+
+   template<>
+   template<>
+   void test_instance::test<5>()
+   {
+      set_test_name("dropped tasks complete the combined future");
+
+         // the futures of the tasks dropped by 'terminate' are broken, the combinator does not hang
+      observable_future<vector<observable_future<int>>> all;
+      {
+         thread_pool tp {1};
+         promise<void> gate;
+         auto g = gate.get_future().share();
+         promise<void> started;
+         vector<observable_future<int>> futures;
+         futures.push_back(tp.submit([g,&started] { started.set_value(); g.wait(); return 1; }));
+         for(int i=0; i<5; ++i)
+            futures.push_back(tp.submit([i] { return i; }));
+         all = thread_ex::when_all(begin(futures), end(futures));
+         started.get_future().wait();
+         thread ender {[&gate] { this_thread::sleep_for(50ms); gate.set_value(); }};
+         tp.terminate();
+         ender.join();
+      }
+      ensure(future_status::ready==all.wait_for(10s));
+      auto done = all.get();
+      ensure(1==done[0].get());
+      size_t broken {0};
+      for(size_t i=1; i<done.size(); ++i)
+      {
+         try
+         {
+            done[i].get();
+         }
+         catch(const future_error& e)
+         {
+            ensure(future_errc::broken_promise==e.code());
+            ++broken;
+         }
+      }
+      ensure(broken > 0);
+   }
+
+   template<>
+   template<>
+   void test_instance::test<6>()
+   {
+      set_test_name("a dropped task is broken before on_ready");
+
+      atomic<int> status {-1};
+      observable_future<int> dropped;   // outlives the pool, the task is dropped by its destructor
+      {
+         thread_pool tp {1};
+         promise<void> gate;
+         auto g = gate.get_future().share();
+         promise<void> started;
+         auto busy = tp.submit([g,&started] { started.set_value(); g.wait(); });
+         dropped = tp.submit([] { return 1; });
+         dropped.on_ready([&dropped,&status] {
+            status = 0;
+            if(future_status::ready!=dropped.wait_for(0s))
+               return;     // get() would block the dropping thread for good
+            try
+            {
+               dropped.get();
+            }
+            catch(const future_error& e)
+            {
+               status = future_errc::broken_promise==e.code();
+            }
+         });
+         started.get_future().wait();
+         thread ender {[&gate] { this_thread::sleep_for(50ms); gate.set_value(); }};
+         tp.terminate();
+         ender.join();
+      }
+      ensure(1==status);
+   }
+
+} // namespace tut